@@ -96,6 +96,7 @@ namespace Config
     const int SplitterProxyWidth {3};
     const bool WidgetExplorerEnabled {false};
     const bool DrawWidgetRects {false};
+    const bool DrawOverdraw {false};
 }
 
 namespace PropertyNames
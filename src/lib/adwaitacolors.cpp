@@ -21,6 +21,7 @@
 
 #include "adwaitacolors.h"
 #include "adwaitacolors_p.h"
+#include "adwaitacolorscheme.h"
 #include "adwaitadebug.h"
 #include "animations/adwaitaanimationdata.h"
 
@@ -29,7 +30,6 @@
 #include <QFile>
 #include <QMetaEnum>
 #include <QRegularExpression>
-#include <QtMath>
 
 Q_LOGGING_CATEGORY(ADWAITA, "adwaita.colors")
 
@@ -415,16 +415,34 @@ QColor ColorsPrivate::adwaitaWidgetColor(const QString &color, ColorVariant vari
     return returnValue;
 }
 
-bool ColorsPrivate::isDarkMode()
+int ColorsPrivate::entryCount() const
 {
-    const QColor textColor = QGuiApplication::palette().color(QPalette::Text);
-    if (qSqrt(((textColor.red() * textColor.red()) * 0.299) +
-              ((textColor.green() * textColor.green()) * 0.587) +
-              ((textColor.blue() * textColor.blue()) * 0.114)) > 128) {
-        return true;
+    int count = 0;
+    for (const QHash<ColorVariant, QColor> &colors : m_colors) {
+        count += colors.size();
+    }
+    for (const QMap<ColorVariant, QColor> &colors : m_widgetColors) {
+        count += colors.size();
     }
 
-    return false;
+    return count;
+}
+
+qint64 ColorsPrivate::byteCount() const
+{
+    qint64 bytes = qint64(entryCount()) * qint64(sizeof(ColorVariant) + sizeof(QColor));
+    for (auto it = m_widgetColors.constBegin(); it != m_widgetColors.constEnd(); ++it) {
+        bytes += qint64(it.key().size()) * qint64(sizeof(QChar));
+    }
+
+    return bytes;
+}
+
+bool ColorsPrivate::isDarkMode()
+{
+    // desktop preference, cached and kept up to date by the settings portal listener
+    const ColorScheme *colorScheme = ColorScheme::instance();
+    return colorScheme && colorScheme->dark();
 }
 
 QPalette Colors::disabledPalette(const QPalette &source, qreal ratio)
@@ -439,6 +457,16 @@ QPalette Colors::disabledPalette(const QPalette &source, qreal ratio)
     return copy;
 }
 
+int Colors::colorTableEntries()
+{
+    return colorsGlobal->entryCount();
+}
+
+qint64 Colors::colorTableBytes()
+{
+    return colorsGlobal->byteCount();
+}
+
 QPalette Colors::palette(ColorVariant variant)
 {
     if (variant == ColorVariant::Unknown) {
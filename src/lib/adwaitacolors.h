@@ -45,6 +45,10 @@ public:
     // Color palette for each Adwaita variant
     static QPalette palette(ColorVariant variant = ColorVariant::Unknown);
 
+    // Diagnostics: entries held by the color tables, and an estimate of their size in bytes
+    static int colorTableEntries();
+    static qint64 colorTableBytes();
+
     // Generic colors
 
     /* Relevant options:
@@ -102,6 +102,10 @@ public:
     QColor adwaitaWidgetColor(const QString &color, ColorVariant variant);
     static bool isDarkMode();
 
+    // Number of entries in the color tables, and an estimate of their size in bytes
+    int entryCount() const;
+    qint64 byteCount() const;
+
 private:
     QHash<AdwaitaColor, QHash<ColorVariant, QColor> > m_colors;
     QHash<QString, QMap<ColorVariant, QColor> > m_widgetColors;
@@ -0,0 +1,152 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitacolorscheme.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QGuiApplication>
+#include <QPalette>
+#include <QPointer>
+#include <QThread>
+
+namespace Adwaita
+{
+
+//*@name settings portal
+//@{
+static const char PortalService[] = "org.freedesktop.portal.Desktop";
+static const char PortalPath[] = "/org/freedesktop/portal/desktop";
+static const char PortalInterface[] = "org.freedesktop.portal.Settings";
+static const char AppearanceGroup[] = "org.freedesktop.appearance";
+static const char ColorSchemeKey[] = "color-scheme";
+//@}
+
+//* portal values come wrapped in one or more variants
+static QVariant unwrap(QVariant value)
+{
+    while (value.userType() == qMetaTypeId<QDBusVariant>()) {
+        value = qvariant_cast<QDBusVariant>(value).variant();
+    }
+
+    return value;
+}
+
+//____________________________________________________________________
+ColorScheme *ColorScheme::instance()
+{
+    static QPointer<ColorScheme> instance;
+    if (!instance && qApp && QThread::currentThread() == qApp->thread()) {
+        instance = new ColorScheme(qApp);
+    }
+
+    return instance.data();
+}
+
+//____________________________________________________________________
+ColorScheme::ColorScheme(QObject *parent)
+    : QObject(parent)
+{
+    // light text means dark colors
+    if (qobject_cast<QGuiApplication *>(qApp)) {
+        const QColor textColor(QGuiApplication::palette().color(QPalette::Text));
+        _paletteDark = (0.299 * textColor.redF() + 0.587 * textColor.greenF() + 0.114 * textColor.blueF()) > 0.5;
+    }
+
+    _dark = _paletteDark;
+
+    QDBusConnection connection(QDBusConnection::sessionBus());
+    if (!connection.isConnected()) {
+        return;
+    }
+
+    connection.connect(QLatin1String(PortalService), QLatin1String(PortalPath), QLatin1String(PortalInterface), QStringLiteral("SettingChanged"),
+                       this, SLOT(settingChanged(QString, QString, QDBusVariant)));
+
+    QDBusMessage message(QDBusMessage::createMethodCall(QLatin1String(PortalService), QLatin1String(PortalPath), QLatin1String(PortalInterface), QStringLiteral("Read")));
+    message << QLatin1String(AppearanceGroup) << QLatin1String(ColorSchemeKey);
+
+    QDBusPendingCallWatcher *watcher(new QDBusPendingCallWatcher(connection.asyncCall(message), this));
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &ColorScheme::readFinished);
+}
+
+//____________________________________________________________________
+void ColorScheme::readFinished(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+
+    // no portal, or no such setting: keep the palette guess
+    const QDBusPendingReply<QVariant> reply(*watcher);
+    if (reply.isError()) {
+        return;
+    }
+
+    // the palette guess may already be on screen, correct it once
+    const bool dark(isDark(reply.value()));
+    if (dark == _dark) {
+        return;
+    }
+
+    _dark = dark;
+    Q_EMIT darkChanged(_dark);
+}
+
+//____________________________________________________________________
+void ColorScheme::settingChanged(const QString &group, const QString &key, const QDBusVariant &value)
+{
+    if (group != QLatin1String(AppearanceGroup) || key != QLatin1String(ColorSchemeKey)) {
+        return;
+    }
+
+    const bool dark(isDark(value.variant()));
+    if (dark == _dark) {
+        return;
+    }
+
+    _dark = dark;
+    Q_EMIT darkChanged(_dark);
+    Q_EMIT toggled(_dark);
+}
+
+//____________________________________________________________________
+bool ColorScheme::isDark(const QVariant &value) const
+{
+    bool ok(false);
+    const uint scheme(unwrap(value).toUInt(&ok));
+    if (!ok) {
+        return _dark;
+    }
+
+    switch (scheme) {
+    case PreferDark:
+        return true;
+    case PreferLight:
+        return false;
+    default:
+        return _paletteDark;
+    }
+}
+
+} // namespace Adwaita
@@ -0,0 +1,96 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_COLOR_SCHEME_H
+#define ADWAITA_COLOR_SCHEME_H
+
+#include "adwaitaqt_export.h"
+
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+class QDBusPendingCallWatcher;
+class QDBusVariant;
+
+namespace Adwaita
+{
+
+//* desktop color scheme preference, from the settings portal
+/**
+ * the org.freedesktop.appearance color-scheme setting is read asynchronously once, then followed
+ * through the portal SettingChanged signal, so that asking whether the desktop is dark costs a
+ * member read. Until the portal answers, or when there is none, the application palette decides,
+ * evaluated once. The session bus address comes from the environment, so a mock portal on a
+ * private bus can stand in for the real one
+ */
+class ADWAITAQT_EXPORT ColorScheme : public QObject
+{
+    Q_OBJECT
+
+public:
+    //* portal color-scheme values
+    enum Scheme {
+        NoPreference = 0,
+        PreferDark = 1,
+        PreferLight = 2
+    };
+
+    //* shared instance, created on first use in the application thread. Null without application
+    static ColorScheme *instance();
+
+    //* true if the desktop prefers dark colors
+    bool dark() const
+    {
+        return _dark;
+    }
+
+Q_SIGNALS:
+    //* emitted once per change of dark(), including when the initial read overrides the palette guess
+    void darkChanged(bool dark);
+
+    //* emitted when the desktop switches between light and dark while running. Not emitted for the initial read
+    void toggled(bool dark);
+
+private Q_SLOTS:
+    //* initial read finished
+    void readFinished(QDBusPendingCallWatcher *);
+
+    //* portal setting changed
+    void settingChanged(const QString &group, const QString &key, const QDBusVariant &value);
+
+private:
+    //* constructor
+    explicit ColorScheme(QObject *parent);
+
+    //* dark state for a portal value. No preference keeps the palette guess
+    bool isDark(const QVariant &value) const;
+
+    //* dark state guessed from the application palette, before the portal answers
+    bool _paletteDark = false;
+
+    //* current dark state
+    bool _dark = false;
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_COLOR_SCHEME_H
@@ -0,0 +1,306 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_PAINTER_STATE_GUARD_H
+#define ADWAITA_PAINTER_STATE_GUARD_H
+
+#include <QBrush>
+#include <QFont>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QTransform>
+
+namespace Adwaita
+{
+
+//* scoped painter state
+/**
+ * lightweight replacement for QPainter::save/restore pairs.
+ * Only the attributes changed through the guard are recorded, on first change,
+ * and put back when the guard goes out of scope. Changes that QPainter cannot
+ * undo cheaply (clipping, viewport, window) fall back to a full save
+ */
+class PainterStateGuard
+{
+public:
+    //* constructor
+    explicit PainterStateGuard(QPainter *painter)
+        : _painter(painter)
+    {
+    }
+
+    //* destructor
+    ~PainterStateGuard()
+    {
+        restore();
+    }
+
+    //* painter
+    QPainter *painter() const
+    {
+        return _painter;
+    }
+
+    //*@name pen and brush
+    //@{
+
+    void setPen(const QPen &pen)
+    {
+        record(Pen);
+        _painter->setPen(pen);
+    }
+
+    void setPen(const QColor &color)
+    {
+        record(Pen);
+        _painter->setPen(color);
+    }
+
+    void setPen(Qt::PenStyle style)
+    {
+        record(Pen);
+        _painter->setPen(style);
+    }
+
+    void setBrush(const QBrush &brush)
+    {
+        record(Brush);
+        _painter->setBrush(brush);
+    }
+
+    void setBrush(Qt::BrushStyle style)
+    {
+        record(Brush);
+        _painter->setBrush(style);
+    }
+
+    //@}
+
+    //*@name render hints, opacity and font
+    //@{
+
+    void setRenderHint(QPainter::RenderHint hint, bool on = true)
+    {
+        record(RenderHints);
+        _painter->setRenderHint(hint, on);
+    }
+
+    void setRenderHints(QPainter::RenderHints hints, bool on = true)
+    {
+        record(RenderHints);
+        _painter->setRenderHints(hints, on);
+    }
+
+    void setOpacity(qreal opacity)
+    {
+        record(Opacity);
+        _painter->setOpacity(opacity);
+    }
+
+    void setFont(const QFont &font)
+    {
+        record(Font);
+        _painter->setFont(font);
+    }
+
+    //@}
+
+    //*@name transformations
+    //@{
+
+    void translate(const QPointF &offset)
+    {
+        record(Transform);
+        _painter->translate(offset);
+    }
+
+    void translate(qreal dx, qreal dy)
+    {
+        record(Transform);
+        _painter->translate(dx, dy);
+    }
+
+    void rotate(qreal angle)
+    {
+        record(Transform);
+        _painter->rotate(angle);
+    }
+
+    void scale(qreal sx, qreal sy)
+    {
+        record(Transform);
+        _painter->scale(sx, sy);
+    }
+
+    void setWorldTransform(const QTransform &transform, bool combine = false)
+    {
+        record(Transform);
+        _painter->setWorldTransform(transform, combine);
+    }
+
+    //@}
+
+    //*@name clipping and viewport, these fall back to a full save
+    //@{
+
+    void setClipRect(const QRectF &rect, Qt::ClipOperation operation = Qt::ReplaceClip)
+    {
+        save();
+        _painter->setClipRect(rect, operation);
+    }
+
+    void setClipRect(const QRect &rect, Qt::ClipOperation operation = Qt::ReplaceClip)
+    {
+        save();
+        _painter->setClipRect(rect, operation);
+    }
+
+    void setClipPath(const QPainterPath &path, Qt::ClipOperation operation = Qt::ReplaceClip)
+    {
+        save();
+        _painter->setClipPath(path, operation);
+    }
+
+    void setViewport(const QRect &rect)
+    {
+        save();
+        _painter->setViewport(rect);
+    }
+
+    void setWindow(int x, int y, int width, int height)
+    {
+        save();
+        _painter->setWindow(x, y, width, height);
+    }
+
+    //@}
+
+    //* full save, for changes not covered above. Restored by the destructor
+    void save()
+    {
+        if (!_saved) {
+            _painter->save();
+            _saved = true;
+        }
+    }
+
+    //* restore everything that was changed through the guard
+    void restore()
+    {
+        if (_saved) {
+            _painter->restore();
+            _saved = false;
+        }
+
+        if (!_recorded) {
+            return;
+        }
+
+        if (_recorded & Pen) {
+            _painter->setPen(_pen);
+        }
+        if (_recorded & Brush) {
+            _painter->setBrush(_brush);
+        }
+        if (_recorded & RenderHints) {
+            _painter->setRenderHints(_painter->renderHints() & ~_renderHints, false);
+            _painter->setRenderHints(_renderHints, true);
+        }
+        if (_recorded & Opacity) {
+            _painter->setOpacity(_opacity);
+        }
+        if (_recorded & Font) {
+            _painter->setFont(_font);
+        }
+        if (_recorded & Transform) {
+            _painter->setWorldTransform(_transform);
+        }
+
+        _recorded = 0;
+    }
+
+private:
+    //* recorded attributes
+    enum Attribute {
+        Pen = 1 << 0,
+        Brush = 1 << 1,
+        RenderHints = 1 << 2,
+        Opacity = 1 << 3,
+        Font = 1 << 4,
+        Transform = 1 << 5,
+    };
+
+    //* store attribute's current value, unless already stored or covered by a full save
+    void record(Attribute attribute)
+    {
+        if (_saved || (_recorded & attribute)) {
+            return;
+        }
+
+        _recorded |= attribute;
+        switch (attribute) {
+        case Pen:
+            _pen = _painter->pen();
+            break;
+        case Brush:
+            _brush = _painter->brush();
+            break;
+        case RenderHints:
+            _renderHints = _painter->renderHints();
+            break;
+        case Opacity:
+            _opacity = _painter->opacity();
+            break;
+        case Font:
+            _font = _painter->font();
+            break;
+        case Transform:
+            _transform = _painter->worldTransform();
+            break;
+        }
+    }
+
+    Q_DISABLE_COPY(PainterStateGuard)
+
+    //* painter
+    QPainter *_painter;
+
+    //* true if a full save was needed
+    bool _saved = false;
+
+    //* recorded attributes
+    int _recorded = 0;
+
+    //*@name original values
+    //@{
+    QPen _pen;
+    QBrush _brush;
+    QPainter::RenderHints _renderHints;
+    qreal _opacity = 1.0;
+    QFont _font;
+    QTransform _transform;
+    //@}
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_PAINTER_STATE_GUARD_H
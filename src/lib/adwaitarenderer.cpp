@@ -20,11 +20,14 @@
  *************************************************************************/
 
 #include "adwaitarenderer.h"
+#include "adwaitarenderer_p.h"
 #include "adwaitacolors.h"
+#include "adwaitapainterstateguard.h"
 
 #include <QPainter>
 #include <QPainterPath>
 #include <QRect>
+#include <QtMath>
 
 #include <cmath>
 
@@ -35,6 +38,33 @@
 namespace Adwaita
 {
 
+Q_GLOBAL_STATIC(RendererPrivate, rendererGlobal)
+
+RendererPrivate::RendererPrivate()
+    : indicatorSprites(IndicatorSpriteCost)
+    , glyphs(GlyphCost)
+    , paths(PathCount)
+{
+}
+
+HashValue qHash(const IndicatorSpriteKey &key, HashValue seed)
+{
+    return hashValues(seed, key.type, key.size.width(), key.size.height(), key.variant,
+                      key.devicePixelRatio, key.color, key.outlineColor, key.tickColor, key.flags);
+}
+
+HashValue qHash(const GlyphKey &key, HashValue seed)
+{
+    return hashValues(seed, key.glyph, key.variant, key.size.width(), key.size.height(),
+                      key.color, key.outlineColor, key.devicePixelRatio, int(key.antialiasing));
+}
+
+HashValue qHash(const PathKey &key, HashValue seed)
+{
+    return hashValues(seed, key.shape, key.size.width(), key.size.height(),
+                      key.radius, key.extra, key.devicePixelRatio);
+}
+
 static qreal frameRadius(qreal bias = 0)
 {
     return qMax(qreal(Metrics::Frame_FrameRadius) - 0.5 + bias, 0.0);
@@ -94,18 +124,238 @@ static QPainterPath roundedPath(const QRectF &rect, Corners corners, qreal radiu
     return path;
 }
 
+//* device pixel ratio of the painter target
+static qreal painterDevicePixelRatio(const QPainter *painter)
+{
+    return painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+}
+
+//* true if integer rects land exactly on device pixels, in which case antialiasing cannot change how they are filled
+static bool isPixelAligned(const QPainter *painter)
+{
+    const QTransform &transform(painter->transform());
+    if (transform.type() > QTransform::TxTranslate
+            || transform.dx() != qRound(transform.dx())
+            || transform.dy() != qRound(transform.dy())) {
+        return false;
+    }
+
+    const qreal devicePixelRatio(painterDevicePixelRatio(painter));
+    return devicePixelRatio == qRound(devicePixelRatio);
+}
+
+//* true if one pixel wide aliased lines at integer coordinates cover exactly the pixels a fillRect would
+/**
+ * integer fillRect ignores antialiasing, so callers whose lines are antialiased must keep drawing them
+ */
+static bool isPixelAlignedLine(const QPainter *painter)
+{
+    return isPixelAligned(painter) && painterDevicePixelRatio(painter) == 1.0;
+}
+
+//* key for a path of given shape and size, built at the origin
+static PathKey pathKey(PathKey::Shape shape, const QSizeF &size, qreal radius, int extra, const QPainter *painter)
+{
+    PathKey key;
+    key.shape = shape;
+    key.size = QSize(qRound(size.width() * 4), qRound(size.height() * 4));
+    key.radius = qRound(radius * 4);
+    key.extra = extra;
+    key.devicePixelRatio = qRound(painterDevicePixelRatio(painter) * 100);
+    return key;
+}
+
+//* returns cached path for key, building and flattening it on first use
+/**
+ * curves are flattened once at device resolution, so that the paint engine
+ * only has to deal with polygons afterwards. Scaled painters would show the
+ * flattening, and the cache is not thread safe, so the path is built directly then
+ */
+template<typename Build>
+static QPainterPath cachedPath(const QPainter *painter, const PathKey &key, Build build)
+{
+    if (!canUsePixmapCache(painter)) {
+        return build();
+    }
+
+    if (const QPainterPath *path = rendererGlobal->paths.object(key)) {
+        ++rendererGlobal->pathHits;
+        return *path;
+    }
+
+    ++rendererGlobal->pathMisses;
+
+    const QPainterPath path(build());
+    const qreal devicePixelRatio(key.devicePixelRatio / 100.0);
+    const QTransform toDevice(QTransform::fromScale(devicePixelRatio, devicePixelRatio));
+
+    QPainterPath flattened;
+    flattened.setFillRule(path.fillRule());
+    const QList<QPolygonF> polygons(path.toSubpathPolygons(toDevice));
+    for (const QPolygonF &polygon : polygons) {
+        flattened.addPolygon(polygon);
+        if (polygon.size() > 2 && polygon.isClosed()) {
+            flattened.closeSubpath();
+        }
+    }
+
+    flattened = toDevice.inverted().map(flattened);
+    rendererGlobal->paths.insert(key, new QPainterPath(flattened));
+    return flattened;
+}
+
+//* cached glyph pixmap, rendered with paint on first use. Returns nullptr if it cannot be cached
+template<typename Paint>
+static const QPixmap *glyphPixmap(const GlyphKey &key, const QSize &size, qreal devicePixelRatio, Paint paint)
+{
+    if (const QPixmap *pixmap = rendererGlobal->glyphs.object(key)) {
+        ++rendererGlobal->glyphHits;
+        return pixmap;
+    }
+
+    ++rendererGlobal->glyphMisses;
+
+    QPixmap *pixmap(new QPixmap(qCeil(size.width() * devicePixelRatio), qCeil(size.height() * devicePixelRatio)));
+    pixmap->setDevicePixelRatio(devicePixelRatio);
+    pixmap->fill(Qt::transparent);
+    {
+        QPainter painter(pixmap);
+        paint(&painter);
+    }
+
+    // insert takes ownership, and deletes the pixmap right away if it does not fit
+    if (!rendererGlobal->glyphs.insert(key, pixmap, pixmap->width() * pixmap->height())) {
+        return nullptr;
+    }
+
+    return pixmap;
+}
+
+//* tallest gradient that is cached as a strip, in logical pixels
+static const int GradientStripHeight = 512;
+
+//* brush for a vertical gradient
+/**
+ * two stop gradients are rendered once into a one pixel wide strip, per colors, height and
+ * device pixel ratio, which the paint engine then only has to tile horizontally. Gradients
+ * with identical stops become solid brushes. Anything else is left as is
+ */
+static QBrush gradientBrush(const QLinearGradient &gradient, const QPainter *painter)
+{
+    const QGradientStops stops(gradient.stops());
+    if (stops.isEmpty()) {
+        return QBrush(gradient);
+    }
+
+    if (stops.size() == 1 || (stops.size() == 2 && stops.first().second == stops.last().second)) {
+        return QBrush(stops.first().second);
+    }
+
+    const QPointF start(gradient.start());
+    const QPointF finalStop(gradient.finalStop());
+    const qreal top(qMin(start.y(), finalStop.y()));
+    const qreal height(qAbs(finalStop.y() - start.y()));
+    if (stops.size() != 2 || stops.first().first != 0 || stops.last().first != 1
+            || start.x() != finalStop.x() || gradient.spread() != QGradient::PadSpread
+            || height < 1 || height > GradientStripHeight || height != qRound(height)
+            || !canUsePixmapCache(painter)) {
+        return QBrush(gradient);
+    }
+
+    // strips always go top to bottom
+    const bool reversed(start.y() > finalStop.y());
+    const QColor topColor(reversed ? stops.last().second : stops.first().second);
+    const QColor bottomColor(reversed ? stops.first().second : stops.last().second);
+    const qreal devicePixelRatio(painterDevicePixelRatio(painter));
+
+    GlyphKey key;
+    key.glyph = GlyphKey::GradientStrip;
+    key.size = QSize(1, qRound(height));
+    key.color = topColor.rgba();
+    key.outlineColor = bottomColor.rgba();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+    const QPixmap *pixmap = glyphPixmap(key, key.size, devicePixelRatio, [&](QPainter *stripPainter) {
+        QLinearGradient strip(0, 0, 0, height);
+        strip.setColorAt(0, topColor);
+        strip.setColorAt(1, bottomColor);
+        stripPainter->setCompositionMode(QPainter::CompositionMode_Source);
+        stripPainter->fillRect(QRectF(0, 0, 1, height), strip);
+    });
+
+    if (!pixmap) {
+        return QBrush(gradient);
+    }
+
+    // texture brushes are anchored at the origin, move the strip to where the gradient starts
+    QBrush brush(*pixmap);
+    brush.setTransform(QTransform::fromTranslate(0, top));
+    return brush;
+}
+
+Renderer::CacheStatistics Renderer::pathCacheStatistics()
+{
+    CacheStatistics statistics;
+    statistics.hits = rendererGlobal->pathHits;
+    statistics.misses = rendererGlobal->pathMisses;
+    statistics.count = rendererGlobal->paths.count();
+    statistics.maxCount = rendererGlobal->paths.maxCost();
+    statistics.entries = statistics.count;
+
+    const QList<PathKey> keys(rendererGlobal->paths.keys());
+    for (const PathKey &key : keys) {
+        if (const QPainterPath *path = rendererGlobal->paths.object(key)) {
+            statistics.bytes += qint64(sizeof(QPainterPath)) + qint64(path->elementCount()) * qint64(sizeof(QPainterPath::Element));
+        }
+    }
+    return statistics;
+}
+
+Renderer::CacheStatistics Renderer::glyphCacheStatistics()
+{
+    CacheStatistics statistics;
+    statistics.hits = rendererGlobal->glyphHits;
+    statistics.misses = rendererGlobal->glyphMisses;
+    statistics.count = rendererGlobal->glyphs.totalCost();
+    statistics.maxCount = rendererGlobal->glyphs.maxCost();
+    statistics.entries = rendererGlobal->glyphs.count();
+    statistics.bytes = qint64(statistics.count) * 4;
+    return statistics;
+}
+
+Renderer::CacheStatistics Renderer::indicatorSpriteCacheStatistics()
+{
+    CacheStatistics statistics;
+    statistics.hits = rendererGlobal->indicatorSpriteHits;
+    statistics.misses = rendererGlobal->indicatorSpriteMisses;
+    statistics.count = rendererGlobal->indicatorSprites.totalCost();
+    statistics.maxCount = rendererGlobal->indicatorSprites.maxCost();
+    statistics.entries = rendererGlobal->indicatorSprites.count();
+    statistics.bytes = qint64(statistics.count) * 4;
+    return statistics;
+}
+
+void Renderer::resetCacheStatistics()
+{
+    rendererGlobal->pathHits = 0;
+    rendererGlobal->pathMisses = 0;
+    rendererGlobal->glyphHits = 0;
+    rendererGlobal->glyphMisses = 0;
+    rendererGlobal->indicatorSpriteHits = 0;
+    rendererGlobal->indicatorSpriteMisses = 0;
+}
+
 void Renderer::renderDebugFrame(const StyleOptions &options)
 {
     if (!options.painter()) {
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHints(QPainter::Antialiasing);
-    options.painter()->setBrush(Qt::NoBrush);
-    options.painter()->setPen(Qt::red);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHints(QPainter::Antialiasing);
+    guard.setBrush(Qt::NoBrush);
+    guard.setPen(Qt::red);
     options.painter()->drawRect(QRectF(options.rect()).adjusted(0.5, 0.5, -0.5, -0.5));
-    options.painter()->restore();
 }
 
 void Renderer::renderFocusRect(const StyleOptions &options, Sides sides)
@@ -118,15 +368,21 @@ void Renderer::renderFocusRect(const StyleOptions &options, Sides sides)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHints(QPainter::Antialiasing);
-    options.painter()->setBrush(options.color());
+    // plain rect fill
+    if (!(options.outlineColor().isValid() && sides) && isPixelAligned(options.painter())) {
+        options.painter()->fillRect(options.rect(), options.color());
+        return;
+    }
+
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHints(QPainter::Antialiasing);
+    guard.setBrush(options.color());
 
     if (!(options.outlineColor().isValid() && sides)) {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
         options.painter()->drawRect(options.rect());
     } else {
-        options.painter()->setClipRect(options.rect());
+        guard.setClipRect(options.rect());
 
         QRectF copy(options.rect());
         copy.adjust(0.5, 0.5, -0.5, -0.5);
@@ -145,12 +401,10 @@ void Renderer::renderFocusRect(const StyleOptions &options, Sides sides)
             copy.adjust(0, 0, radius, 0);
         }
 
-        options.painter()->setPen(options.outlineColor());
+        guard.setPen(options.outlineColor());
         // options.painter()->setBrush( Qt::NoBrush );
         options.painter()->drawRoundedRect(copy, radius, radius);
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderFocusLine(const StyleOptions &options)
@@ -163,18 +417,16 @@ void Renderer::renderFocusLine(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
+    PainterStateGuard guard(options.painter());
 
     QPen pen(options.color(), 1);
     pen.setStyle(Qt::DotLine);
 
-    options.painter()->setRenderHint(QPainter::Antialiasing, false);
-    options.painter()->setPen(pen);
-    options.painter()->setBrush(Qt::NoBrush);
+    guard.setRenderHint(QPainter::Antialiasing, false);
+    guard.setPen(pen);
+    guard.setBrush(Qt::NoBrush);
 
     options.painter()->drawRoundedRect(options.rect(), 1, 1);
-
-    options.painter()->restore();
 }
 
 void Renderer::renderFrame(const StyleOptions &options)
@@ -183,8 +435,8 @@ void Renderer::renderFrame(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing);
 
     QRectF frameRect(options.rect().adjusted(1, 1, -1, -1));
     qreal radius(frameRadius());
@@ -192,28 +444,27 @@ void Renderer::renderFrame(const StyleOptions &options)
     // set pen
     if (options.outlineColor().isValid()) {
         if (options.hasFocus()) {
-            options.painter()->setPen(QPen(options.outlineColor(), 2));
+            guard.setPen(QPen(options.outlineColor(), 2));
             frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         } else {
-            options.painter()->setPen(options.outlineColor());
+            guard.setPen(options.outlineColor());
         }
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
 
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // set brush
     if (options.color().isValid()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     // render
     options.painter()->drawRoundedRect(frameRect, radius, radius);
-    options.painter()->restore();
 }
 
 void Renderer::renderSquareFrame(const StyleOptions &options)
@@ -222,15 +473,31 @@ void Renderer::renderSquareFrame(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setPen(options.color());
+    // draw aliased outlines as filled rects
+    if (isPixelAlignedLine(options.painter()) && !options.painter()->testRenderHint(QPainter::Antialiasing)) {
+        const QRect frameRect(options.rect().adjusted(1, 1, -2, -2));
+        options.painter()->fillRect(frameRect.left(), frameRect.top(), frameRect.width() + 1, 1, options.color());
+        options.painter()->fillRect(frameRect.left(), frameRect.bottom() + 1, frameRect.width() + 1, 1, options.color());
+        options.painter()->fillRect(frameRect.left(), frameRect.top() + 1, 1, frameRect.height() - 1, options.color());
+        options.painter()->fillRect(frameRect.right() + 1, frameRect.top() + 1, 1, frameRect.height() - 1, options.color());
+        if (options.hasFocus()) {
+            const QRect focusRect(options.rect().adjusted(0, 0, -1, -1));
+            options.painter()->fillRect(focusRect.left(), focusRect.top(), focusRect.width() + 1, 1, options.color());
+            options.painter()->fillRect(focusRect.left(), focusRect.bottom() + 1, focusRect.width() + 1, 1, options.color());
+            options.painter()->fillRect(focusRect.left(), focusRect.top() + 1, 1, focusRect.height() - 1, options.color());
+            options.painter()->fillRect(focusRect.right() + 1, focusRect.top() + 1, 1, focusRect.height() - 1, options.color());
+        }
+        return;
+    }
+
+    PainterStateGuard guard(options.painter());
+    guard.setPen(options.color());
     options.painter()->drawRect(options.rect().adjusted(1, 1, -2, -2));
     if (options.hasFocus()) {
         options.color().setAlphaF(0.5);
-        options.painter()->setPen(options.color());
+        guard.setPen(options.color());
         options.painter()->drawRect(options.rect().adjusted(0, 0, -1, -1));
     }
-    options.painter()->restore();
 }
 
 void Renderer::renderFlatFrame(const StyleOptions &options)
@@ -239,8 +506,8 @@ void Renderer::renderFlatFrame(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing);
 
     QRectF frameRect(options.rect().adjusted(1, 1, -1, -1));
     qreal radius(frameRadius());
@@ -248,31 +515,34 @@ void Renderer::renderFlatFrame(const StyleOptions &options)
     // set pen
     if (options.outlineColor().isValid()) {
         if (options.hasFocus()) {
-            options.painter()->setPen(QPen(options.outlineColor(), 2));
+            guard.setPen(QPen(options.outlineColor(), 2));
             frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         } else {
-            options.painter()->setPen(options.outlineColor());
+            guard.setPen(options.outlineColor());
         }
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // set brush
     if (options.color().isValid()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
-    QPainterPath path;
-    path.setFillRule(Qt::WindingFill);
-    path.addRect(frameRect.adjusted(2 * radius, 0, 0, 0));
-    path.addRoundedRect(frameRect.adjusted(0, 0, - 2 * radius, 0), radius, radius);
+    const QRectF shapeRect(QPointF(0, 0), frameRect.size());
+    const QPainterPath path(cachedPath(options.painter(), pathKey(PathKey::LeftRoundedRect, shapeRect.size(), radius, 0, options.painter()), [&]() {
+        QPainterPath path;
+        path.setFillRule(Qt::WindingFill);
+        path.addRect(shapeRect.adjusted(2 * radius, 0, 0, 0));
+        path.addRoundedRect(shapeRect.adjusted(0, 0, - 2 * radius, 0), radius, radius);
+        return path.simplified();
+    }));
 
-    options.painter()->drawPath(path.simplified());
-    options.painter()->restore();
+    options.painter()->drawPath(path.translated(frameRect.topLeft()));
 
     // render
     //options.painter()->drawRoundedRect( frameRect, radius, radius );
@@ -285,9 +555,9 @@ void Renderer::renderFlatRoundedButtonFrame(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
+    PainterStateGuard guard(options.painter());
     // setup options.painter()
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -295,26 +565,25 @@ void Renderer::renderFlatRoundedButtonFrame(const StyleOptions &options)
     qreal radius(frameRadius());
 
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(QPen(options.outlineColor(), 1.0));
+        guard.setPen(QPen(options.outlineColor(), 1.0));
 
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // content
         if (options.color().isValid() && options.active()) {
-        options.painter()->setBrush(Colors::buttonBackgroundGradient(options));
+        guard.setBrush(gradientBrush(Colors::buttonBackgroundGradient(options), options.painter()));
     } else if (!options.active()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     // render
     options.painter()->drawEllipse(frameRect);
-    options.painter()->restore();
 }
 
 void Renderer::renderSidePanelFrame(const StyleOptions &options, Side side)
@@ -333,9 +602,9 @@ void Renderer::renderSidePanelFrame(const StyleOptions &options, Side side)
     frameRect.adjust(0.5, 0.5, -0.5, -0.5);
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing);
-    options.painter()->setPen(options.outlineColor());
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing);
+    guard.setPen(options.outlineColor());
 
     // render
     switch (side) {
@@ -363,8 +632,6 @@ void Renderer::renderSidePanelFrame(const StyleOptions &options, Side side)
     default:
         break;
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderMenuFrame(const StyleOptions &options, bool roundCorners)
@@ -373,26 +640,25 @@ void Renderer::renderMenuFrame(const StyleOptions &options, bool roundCorners)
         return;
     }
 
-    options.painter()->save();
+    PainterStateGuard guard(options.painter());
 
     // set brush
     if (options.color().isValid()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
-    options.painter()->setRenderHint(QPainter::Antialiasing, false);
+    guard.setRenderHint(QPainter::Antialiasing, false);
     QRectF frameRect(options.rect());
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(options.outlineColor());
+        guard.setPen(options.outlineColor());
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     options.painter()->drawRect(frameRect);
-    options.painter()->restore();
 }
 
 void Renderer::renderButtonFrame(const StyleOptions &options)
@@ -402,8 +668,8 @@ void Renderer::renderButtonFrame(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -411,34 +677,32 @@ void Renderer::renderButtonFrame(const StyleOptions &options)
     qreal radius(frameRadius());
 
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(QPen(options.outlineColor(), 1.0));
+        guard.setPen(QPen(options.outlineColor(), 1.0));
 
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // content
     if (options.color().isValid() && options.active()) {
-        options.painter()->setBrush(Colors::buttonBackgroundGradient(options));
+        guard.setBrush(gradientBrush(Colors::buttonBackgroundGradient(options), options.painter()));
     } else if (!options.active()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     // render
     options.painter()->drawRoundedRect(frameRect, radius, radius);
 
     if (!options.sunken() && options.active() && options.color().isValid()) {
-        options.painter()->setPen(options.color().lighter(140));
+        guard.setPen(options.color().lighter(140));
         options.painter()->drawLine(frameRect.topLeft() + QPoint(3, 1), frameRect.topRight() + QPoint(-3, 1));
-        options.painter()->setPen(options.outlineColor().darker(114));
+        guard.setPen(options.outlineColor().darker(114));
         options.painter()->drawLine(frameRect.bottomLeft() + QPointF(2.7, 0), frameRect.bottomRight() + QPointF(-2.7, 0));
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderCheckBoxFrame(const StyleOptions &options)
@@ -448,8 +712,8 @@ void Renderer::renderCheckBoxFrame(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -457,25 +721,24 @@ void Renderer::renderCheckBoxFrame(const StyleOptions &options)
     qreal radius(frameRadius());
 
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(QPen(options.outlineColor(), 1.0));
+        guard.setPen(QPen(options.outlineColor(), 1.0));
 
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     if (options.color().isValid() && options.active()) {
-        options.painter()->setBrush(Colors::indicatorBackgroundGradient(options));
+        guard.setBrush(gradientBrush(Colors::indicatorBackgroundGradient(options), options.painter()));
     } else if (!options.active()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     // render
     options.painter()->drawRoundedRect(frameRect, radius, radius);
-    options.painter()->restore();
 }
 
 void Renderer::renderFlatButtonFrame(const StyleOptions &options)
@@ -485,8 +748,8 @@ void Renderer::renderFlatButtonFrame(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -494,12 +757,12 @@ void Renderer::renderFlatButtonFrame(const StyleOptions &options)
     qreal radius(frameRadius());
 
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(QPen(options.outlineColor(), 1.0));
+        guard.setPen(QPen(options.outlineColor(), 1.0));
 
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // content
@@ -516,28 +779,30 @@ void Renderer::renderFlatButtonFrame(const StyleOptions &options)
             gradient.setColorAt(0, Colors::mix(options.color(), Qt::white, 0.07));
             gradient.setColorAt(1, Colors::mix(options.color(), Qt::black, 0.1));
         }
-        options.painter()->setBrush(gradient);
+        guard.setBrush(gradientBrush(gradient, options.painter()));
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
-    QPainterPath path;
-    path.setFillRule(Qt::WindingFill);
-    path.addRoundedRect(frameRect.adjusted(2 * radius, 0, 0, 0), radius, radius);
-    path.addRect(frameRect.adjusted(0, 0, -2 * radius, 0));
-    options.painter()->drawPath(path.simplified());
+    const QRectF shapeRect(QPointF(0, 0), frameRect.size());
+    const QPainterPath path(cachedPath(options.painter(), pathKey(PathKey::RightRoundedRect, shapeRect.size(), radius, 0, options.painter()), [&]() {
+        QPainterPath path;
+        path.setFillRule(Qt::WindingFill);
+        path.addRoundedRect(shapeRect.adjusted(2 * radius, 0, 0, 0), radius, radius);
+        path.addRect(shapeRect.adjusted(0, 0, -2 * radius, 0));
+        return path.simplified();
+    }));
+    options.painter()->drawPath(path.translated(frameRect.topLeft()));
 
     if (!options.sunken() && options.active()) {
-        options.painter()->setPen(options.color().lighter(140));
+        guard.setPen(options.color().lighter(140));
         options.painter()->drawLine(frameRect.topLeft() + QPoint(1, 1), frameRect.topRight() + QPoint(-3, 1));
-        options.painter()->setPen(options.outlineColor().darker(114));
+        guard.setPen(options.outlineColor().darker(114));
         options.painter()->drawLine(frameRect.bottomLeft() + QPointF(0.7, 0), frameRect.bottomRight() + QPointF(-2.7, 0));
     }
 
     // render
     //options.painter()->drawRoundedRect( frameRect, radius, radius );
-
-    options.painter()->restore();
 }
 
 void Renderer::renderToolButtonFrame(const StyleOptions &options)
@@ -551,28 +816,27 @@ void Renderer::renderToolButtonFrame(const StyleOptions &options)
         return;
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHints(QPainter::Antialiasing);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHints(QPainter::Antialiasing);
 
     QRectF baseRect(options.rect());
 
     if (options.sunken()) {
         qreal radius(frameRadius());
 
-        options.painter()->setPen(Qt::NoPen);
-        options.painter()->setBrush(options.color());
+        guard.setPen(Qt::NoPen);
+        guard.setBrush(options.color());
 
         QRectF contentRect(baseRect.adjusted(1, 1, -1, -1));
         options.painter()->drawRoundedRect(contentRect, radius, radius);
     } else {
         qreal radius(frameRadius(-0.5));
 
-        options.painter()->setPen(options.color());
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setPen(options.color());
+        guard.setBrush(Qt::NoBrush);
         QRectF outlineRect(baseRect.adjusted(1.5, 1.5, -1.5, -1.5));
         options.painter()->drawRoundedRect(outlineRect, radius, radius);
     }
-    options.painter()->restore();
 }
 
 void Renderer::renderToolBoxFrame(const StyleOptions &options, int tabWidth)
@@ -600,26 +864,28 @@ void Renderer::renderToolBoxFrame(const StyleOptions &options, int tabWidth)
     baseRect.adjust(0.5, 0.5, -0.5, -0.5);
 
     // create path
-    QPainterPath path;
-    path.moveTo(0, baseRect.height() - 1);
-    path.lineTo((baseRect.width() - tabWidth) / 2 - radius, baseRect.height() - 1);
-    path.arcTo(QRectF(QPointF((baseRect.width() - tabWidth) / 2 - 2 * radius, baseRect.height() - 1 - 2 * radius), cornerSize), 270, 90);
-    path.lineTo((baseRect.width() - tabWidth) / 2, radius);
-    path.arcTo(QRectF(QPointF((baseRect.width() - tabWidth) / 2, 0), cornerSize), 180, -90);
-    path.lineTo((baseRect.width() + tabWidth) / 2 - 1 - radius, 0);
-    path.arcTo(QRectF(QPointF((baseRect.width() + tabWidth) / 2  - 1 - 2 * radius, 0), cornerSize), 90, -90);
-    path.lineTo((baseRect.width() + tabWidth) / 2 - 1, baseRect.height() - 1 - radius);
-    path.arcTo(QRectF(QPointF((baseRect.width() + tabWidth) / 2 - 1, baseRect.height() - 1 - 2 * radius), cornerSize), 180, 90);
-    path.lineTo(baseRect.width() - 1, baseRect.height() - 1);
+    const QPainterPath path(cachedPath(options.painter(), pathKey(PathKey::ToolBoxFrame, baseRect.size(), radius, tabWidth, options.painter()), [&]() {
+        QPainterPath path;
+        path.moveTo(0, baseRect.height() - 1);
+        path.lineTo((baseRect.width() - tabWidth) / 2 - radius, baseRect.height() - 1);
+        path.arcTo(QRectF(QPointF((baseRect.width() - tabWidth) / 2 - 2 * radius, baseRect.height() - 1 - 2 * radius), cornerSize), 270, 90);
+        path.lineTo((baseRect.width() - tabWidth) / 2, radius);
+        path.arcTo(QRectF(QPointF((baseRect.width() - tabWidth) / 2, 0), cornerSize), 180, -90);
+        path.lineTo((baseRect.width() + tabWidth) / 2 - 1 - radius, 0);
+        path.arcTo(QRectF(QPointF((baseRect.width() + tabWidth) / 2  - 1 - 2 * radius, 0), cornerSize), 90, -90);
+        path.lineTo((baseRect.width() + tabWidth) / 2 - 1, baseRect.height() - 1 - radius);
+        path.arcTo(QRectF(QPointF((baseRect.width() + tabWidth) / 2 - 1, baseRect.height() - 1 - 2 * radius), cornerSize), 180, 90);
+        path.lineTo(baseRect.width() - 1, baseRect.height() - 1);
+        return path;
+    }));
 
     // render
-    options.painter()->save();
-    options.painter()->setRenderHints(QPainter::Antialiasing);
-    options.painter()->setBrush(Qt::NoBrush);
-    options.painter()->setPen(options.outlineColor());
-    options.painter()->translate(baseRect.topLeft());
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHints(QPainter::Antialiasing);
+    guard.setBrush(Qt::NoBrush);
+    guard.setPen(options.outlineColor());
+    guard.translate(baseRect.topLeft());
     options.painter()->drawPath(path);
-    options.painter()->restore();
 
     return;
 }
@@ -630,33 +896,34 @@ void Renderer::renderTabWidgetFrame(const StyleOptions &options, Corners corners
         return;
     }
 
-    options.painter()->setRenderHint(QPainter::Antialiasing);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing);
 
     QRectF frameRect(options.rect().adjusted(1, 1, -1, -1));
     qreal radius(frameRadius());
 
-    options.painter()->save();
-
     // set pen
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(options.outlineColor());
+        guard.setPen(options.outlineColor());
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
         radius = qMax(radius - 1, qreal(0.0));
     } else {
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
     }
 
     // set brush
     if (options.color().isValid()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     // render
-    QPainterPath path(roundedPath(frameRect, corners, radius));
-    options.painter()->drawPath(path);
-    options.painter()->restore();
+    const QRectF shapeRect(QPointF(0, 0), frameRect.size());
+    const QPainterPath path(cachedPath(options.painter(), pathKey(PathKey::RoundedRect, shapeRect.size(), radius, corners, options.painter()), [&]() {
+        return roundedPath(shapeRect, corners, radius);
+    }));
+    options.painter()->drawPath(path.translated(frameRect.topLeft()));
 }
 
 void Renderer::renderSelection(const StyleOptions &options)
@@ -665,12 +932,16 @@ void Renderer::renderSelection(const StyleOptions &options)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing);
-    options.painter()->setPen(Qt::NoPen);
-    options.painter()->setBrush(options.color());
+    if (isPixelAligned(options.painter())) {
+        options.painter()->fillRect(options.rect(), options.color());
+        return;
+    }
+
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing);
+    guard.setPen(Qt::NoPen);
+    guard.setBrush(options.color());
     options.painter()->drawRect(options.rect());
-    options.painter()->restore();
 }
 
 void Renderer::renderSeparator(const StyleOptions &options, bool vertical)
@@ -679,20 +950,29 @@ void Renderer::renderSeparator(const StyleOptions &options, bool vertical)
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, false);
-    options.painter()->setBrush(Qt::NoBrush);
-    options.painter()->setPen(options.color());
+    // the line below is aliased, so a filled rect covers the same pixels
+    if (isPixelAlignedLine(options.painter())) {
+        const QRect &rect(options.rect());
+        if (vertical) {
+            options.painter()->fillRect(rect.left() + rect.width() / 2, rect.top(), 1, rect.height(), options.color());
+        } else {
+            options.painter()->fillRect(rect.left(), rect.top() + rect.height() / 2, rect.width(), 1, options.color());
+        }
+        return;
+    }
+
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, false);
+    guard.setBrush(Qt::NoBrush);
+    guard.setPen(options.color());
 
     if (vertical) {
-        options.painter()->translate(options.rect().width() / 2, 0);
+        guard.translate(options.rect().width() / 2, 0);
         options.painter()->drawLine(options.rect().topLeft(), options.rect().bottomLeft());
     } else {
-        options.painter()->translate(0, options.rect().height() / 2);
+        guard.translate(0, options.rect().height() / 2);
         options.painter()->drawLine(options.rect().topLeft(), options.rect().topRight());
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderCheckBoxBackground(const StyleOptions &options)
@@ -702,28 +982,140 @@ void Renderer::renderCheckBoxBackground(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect() and radius
     QRectF frameRect(options.rect());
     frameRect.adjust(3, 3, -3, -3);
 
-    options.painter()->setPen(options.outlineColor());
-    options.painter()->setBrush(options.color());
+    guard.setPen(options.outlineColor());
+    guard.setBrush(options.color());
     options.painter()->drawRect(frameRect);
-    options.painter()->restore();
 }
 
-void Renderer::renderCheckBox(const StyleOptions &options, const QColor &tickColor, qreal animation)
+//* paints an indicator for the given options
+using IndicatorFunction = void (*)(const StyleOptions &options, const QColor &tickColor, qreal animation);
+
+//* animation progress matching a sprite frame, -1 for static states
+static qreal indicatorFrameAnimation(int frame)
 {
-    if (!options.painter()) {
-        return;
+    if (frame < IndicatorSpriteSheet::FrameAnimated) {
+        return -1;
+    }
+
+    return qreal(frame - IndicatorSpriteSheet::FrameAnimated) / Config::AnimationSteps;
+}
+
+//* sprite frame for an animated state, quantized to the configured animation steps
+static int indicatorAnimatedFrame(qreal animation)
+{
+    return IndicatorSpriteSheet::FrameAnimated + qRound(qBound(qreal(0.0), animation, qreal(1.0)) * Config::AnimationSteps);
+}
+
+//* blits the requested frame from the matching sprite sheet, rendering it first if needed
+/** returns false if the indicator cannot be cached, in which case it must be painted directly */
+static bool renderIndicatorSprite(IndicatorSpriteKey::Type type, const StyleOptions &options, const QColor &tickColor, int frame, IndicatorFunction function)
+{
+    QPainter *painter(options.painter());
+    const QRect rect(options.rect());
+
+    // keep sheets small, and only use them for plain translations
+    if (rect.isEmpty() || rect.width() > 64 || rect.height() > 64 || !canUsePixmapCache(painter)) {
+        return false;
+    }
+
+    // hover and press transitions blend colors with the animation opacity, so are painted directly
+    if (options.animationMode() != AnimationNone) {
+        return false;
+    }
+
+    const qreal devicePixelRatio(painter->device() ? painter->device()->devicePixelRatioF() : 1.0);
+
+    IndicatorSpriteKey key;
+    key.type = type;
+    key.size = rect.size();
+    key.variant = options.colorVariant();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+    key.color = options.color().rgba();
+    key.outlineColor = options.outlineColor().rgba();
+    key.tickColor = tickColor.rgba();
+    if (options.active()) {
+        key.flags |= IndicatorSpriteKey::Active;
+    }
+    if (options.sunken()) {
+        key.flags |= IndicatorSpriteKey::Sunken;
+    }
+    if (options.mouseOver()) {
+        key.flags |= IndicatorSpriteKey::MouseOver;
+    }
+    if (options.inMenu()) {
+        key.flags |= IndicatorSpriteKey::InMenu;
+    }
+    if (options.palette().currentColorGroup() == QPalette::Disabled) {
+        key.flags |= IndicatorSpriteKey::Disabled;
+    }
+    if (options.color().isValid()) {
+        key.flags |= IndicatorSpriteKey::ColorValid;
+    }
+    if (options.outlineColor().isValid()) {
+        key.flags |= IndicatorSpriteKey::OutlineColorValid;
+    }
+    if (tickColor.isValid()) {
+        key.flags |= IndicatorSpriteKey::TickColorValid;
     }
 
+    IndicatorSpriteSheet *sheet(rendererGlobal->indicatorSprites.object(key));
+    if (sheet) {
+        ++rendererGlobal->indicatorSpriteHits;
+    } else {
+        ++rendererGlobal->indicatorSpriteMisses;
+        sheet = new IndicatorSpriteSheet;
+
+        // align frames on device pixels, so that they render the same as when painted directly
+        sheet->frameWidth = qCeil(rect.width() * devicePixelRatio);
+        sheet->pixmap = QPixmap(sheet->frameWidth * IndicatorSpriteSheet::FrameCount, qCeil(rect.height() * devicePixelRatio));
+        sheet->pixmap.setDevicePixelRatio(devicePixelRatio);
+        sheet->pixmap.fill(Qt::transparent);
+        sheet->ready.resize(IndicatorSpriteSheet::FrameCount);
+
+        // insert takes ownership, and deletes the sheet right away if it does not fit
+        if (!rendererGlobal->indicatorSprites.insert(key, sheet, sheet->pixmap.width() * sheet->pixmap.height())) {
+            return false;
+        }
+    }
+
+    if (!sheet->ready.testBit(frame)) {
+        QPainter spritePainter(&sheet->pixmap);
+        spritePainter.translate(frame * sheet->frameWidth / devicePixelRatio, 0);
+        spritePainter.setClipRect(QRect(QPoint(0, 0), rect.size()));
+
+        StyleOptions spriteOptions(options.palette(), options.colorVariant());
+        spriteOptions.setPainter(&spritePainter);
+        spriteOptions.setRect(QRect(QPoint(0, 0), rect.size()));
+        spriteOptions.setColor(options.color());
+        spriteOptions.setOutlineColor(options.outlineColor());
+        spriteOptions.setActive(options.active());
+        spriteOptions.setSunken(options.sunken());
+        spriteOptions.setMouseOver(options.mouseOver());
+        spriteOptions.setInMenu(options.inMenu());
+        spriteOptions.setCheckboxState(options.checkboxState());
+        spriteOptions.setRadioButtonState(options.radioButtonState());
+
+        function(spriteOptions, tickColor, indicatorFrameAnimation(frame));
+        sheet->ready.setBit(frame);
+    }
+
+    const QRectF source(frame * sheet->frameWidth, 0, rect.width() * devicePixelRatio, rect.height() * devicePixelRatio);
+    painter->drawPixmap(QRectF(rect), sheet->pixmap, source);
+    return true;
+}
+
+static void drawCheckBox(const StyleOptions &options, const QColor &tickColor, qreal animation)
+{
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect() and radius
     QRectF frameRect(options.rect());
@@ -741,17 +1133,17 @@ void Renderer::renderCheckBox(const StyleOptions &options, const QColor &tickCol
         tmpStyleOptions.setCheckboxState(options.checkboxState());
         tmpStyleOptions.setColorVariant(options.colorVariant());
         tmpStyleOptions.setInMenu(options.inMenu());
-        renderCheckBoxFrame(tmpStyleOptions);
+        Renderer::renderCheckBoxFrame(tmpStyleOptions);
     }
 
     // mark
     if (options.checkboxState() == CheckOn) {
-        options.painter()->save();
-        options.painter()->setRenderHint(QPainter::Antialiasing);
-        options.painter()->setBrush(Qt::NoBrush);
+        PainterStateGuard markGuard(options.painter());
+        markGuard.setRenderHint(QPainter::Antialiasing);
+        markGuard.setBrush(Qt::NoBrush);
         QPen pen(tickColor, 3);
         pen.setJoinStyle(Qt::MiterJoin);
-        options.painter()->setPen(pen);
+        markGuard.setPen(pen);
 
         QRectF markerRect(frameRect);
 
@@ -760,24 +1152,23 @@ void Renderer::renderCheckBox(const StyleOptions &options, const QColor &tickCol
         path.lineTo(markerRect.center().x(), markerRect.bottom() - markerRect.height() / 3.0);
         path.lineTo(markerRect.left() + markerRect.width() / 4, markerRect.center().y());
 
-        options.painter()->setClipRect(markerRect);
+        markGuard.setClipRect(markerRect);
         options.painter()->drawPath(path);
-        options.painter()->restore();
     } else if (options.checkboxState() == CheckPartial) {
         QPen pen(tickColor, 4);
         pen.setCapStyle(Qt::RoundCap);
-        options.painter()->setPen(pen);
+        guard.setPen(pen);
 
         QRectF markerRect(frameRect.adjusted(4, 4, -4, -4));
 
         options.painter()->drawLine(markerRect.center() - QPoint(3, 0), markerRect.center() + QPoint(3, 0));
     } else if (options.checkboxState() == CheckAnimated) {
-        options.painter()->save();
-        options.painter()->setRenderHint(QPainter::Antialiasing);
-        options.painter()->setBrush(Qt::NoBrush);
+        PainterStateGuard markGuard(options.painter());
+        markGuard.setRenderHint(QPainter::Antialiasing);
+        markGuard.setBrush(Qt::NoBrush);
         QPen pen(tickColor, 3);
         pen.setJoinStyle(Qt::MiterJoin);
-        options.painter()->setPen(pen);
+        markGuard.setPen(pen);
 
         QRectF markerRect(frameRect);
 
@@ -787,14 +1178,37 @@ void Renderer::renderCheckBox(const StyleOptions &options, const QColor &tickCol
         path.lineTo(markerRect.left() + markerRect.width() / 4, markerRect.center().y());
         path.translate(-markerRect.right(), -markerRect.top());
 
-        options.painter()->setClipRect(markerRect.adjusted(1, 1, -1, -1));
-        options.painter()->translate(markerRect.right(), markerRect.top());
-        options.painter()->scale(animation, 0.5 + 0.5 * animation);
+        markGuard.setClipRect(markerRect.adjusted(1, 1, -1, -1));
+        markGuard.translate(markerRect.right(), markerRect.top());
+        markGuard.scale(animation, 0.5 + 0.5 * animation);
         options.painter()->drawPath(path);
-        options.painter()->restore();
+    }
+}
+
+void Renderer::renderCheckBox(const StyleOptions &options, const QColor &tickColor, qreal animation)
+{
+    if (!options.painter()) {
+        return;
     }
 
-    options.painter()->restore();
+    int frame(IndicatorSpriteSheet::FrameOff);
+    switch (options.checkboxState()) {
+    case CheckOn:
+        frame = IndicatorSpriteSheet::FrameOn;
+        break;
+    case CheckPartial:
+        frame = IndicatorSpriteSheet::FramePartial;
+        break;
+    case CheckAnimated:
+        frame = indicatorAnimatedFrame(animation);
+        break;
+    default:
+        break;
+    }
+
+    if (!renderIndicatorSprite(IndicatorSpriteKey::CheckBox, options, tickColor, frame, &drawCheckBox)) {
+        drawCheckBox(options, tickColor, animation);
+    }
 }
 
 void Renderer::renderRadioButtonBackground(const StyleOptions &options)
@@ -804,8 +1218,8 @@ void Renderer::renderRadioButtonBackground(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -814,56 +1228,72 @@ void Renderer::renderRadioButtonBackground(const StyleOptions &options)
         frameRect.translate(1, 1);
     }
 
-    options.painter()->setPen(options.outlineColor());
-    options.painter()->setBrush(options.color());
+    guard.setPen(options.outlineColor());
+    guard.setBrush(options.color());
     options.painter()->drawEllipse(frameRect);
-    options.painter()->restore();
 }
 
-void Renderer::renderRadioButton(const StyleOptions &options, const QColor &tickColor, qreal animation)
+static void drawRadioButton(const StyleOptions &options, const QColor &tickColor, qreal animation)
 {
-    if (!options.painter()) {
-        return;
-    }
-
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
     frameRect.adjust(2, 2, -2, -2);
 
     if (options.color().isValid() && options.active()) {
-        options.painter()->setBrush(Colors::indicatorBackgroundGradient(options));
+        guard.setBrush(gradientBrush(Colors::indicatorBackgroundGradient(options), options.painter()));
     } else if (!options.active()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
-    options.painter()->setPen(QPen(options.outlineColor(), 1));
+    guard.setPen(QPen(options.outlineColor(), 1));
     QRectF contentRect(frameRect.adjusted(0.5, 0.5, -0.5, -0.5));
     options.painter()->drawEllipse(contentRect);
 
     // mark
     if (options.radioButtonState() == RadioOn) {
-        options.painter()->setBrush(tickColor);
-        options.painter()->setPen(Qt::NoPen);
+        guard.setBrush(tickColor);
+        guard.setPen(Qt::NoPen);
 
         QRectF markerRect(frameRect.adjusted(5, 5, -5, -5));
         options.painter()->drawEllipse(markerRect);
     } else if (options.radioButtonState() == RadioAnimated) {
-        options.painter()->setBrush(tickColor);
-        options.painter()->setPen(Qt::NoPen);
+        guard.setBrush(tickColor);
+        guard.setPen(Qt::NoPen);
         QRectF markerRect(frameRect.adjusted(5, 5, -5, -5));
         qreal remaining = markerRect.width() / 2.0 * (1.0 - animation);
         markerRect.adjust(remaining, remaining, -remaining, -remaining);
 
         options.painter()->drawEllipse(markerRect);
     }
+}
+
+void Renderer::renderRadioButton(const StyleOptions &options, const QColor &tickColor, qreal animation)
+{
+    if (!options.painter()) {
+        return;
+    }
+
+    int frame(IndicatorSpriteSheet::FrameOff);
+    switch (options.radioButtonState()) {
+    case RadioOn:
+        frame = IndicatorSpriteSheet::FrameOn;
+        break;
+    case RadioAnimated:
+        frame = indicatorAnimatedFrame(animation);
+        break;
+    default:
+        break;
+    }
 
-    options.painter()->restore();
+    if (!renderIndicatorSprite(IndicatorSpriteKey::RadioButton, options, tickColor, frame, &drawRadioButton)) {
+        drawRadioButton(options, tickColor, animation);
+    }
 }
 
 void Renderer::renderSliderGroove(const StyleOptions &options)
@@ -873,20 +1303,18 @@ void Renderer::renderSliderGroove(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     QRectF baseRect(options.rect());
     qreal radius(0.5 * Metrics::Slider_GrooveThickness);
 
     // content
     if (options.color().isValid()) {
-        options.painter()->setPen(Qt::NoPen);
-        options.painter()->setBrush(options.color());
+        guard.setPen(Qt::NoPen);
+        guard.setBrush(options.color());
         options.painter()->drawRoundedRect(baseRect, radius, radius);
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderSliderHandle(const StyleOptions &options, Side ticks, qreal angle)
@@ -896,8 +1324,8 @@ void Renderer::renderSliderHandle(const StyleOptions &options, Side ticks, qreal
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     // copy options.rect()
     QRectF frameRect(options.rect());
@@ -908,19 +1336,19 @@ void Renderer::renderSliderHandle(const StyleOptions &options, Side ticks, qreal
         QPen pen(options.outlineColor());
         pen.setCapStyle(Qt::FlatCap);
         pen.setJoinStyle(Qt::MiterJoin);
-        options.painter()->setPen(pen);
+        guard.setPen(pen);
 
         frameRect.adjust(0.5, 0.5, -0.5, -0.5);
     } else
-        options.painter()->setPen(Qt::NoPen);
+        guard.setPen(Qt::NoPen);
 
     // set brush
     if (options.color().isValid() && options.active()) {
-        options.painter()->setBrush(Colors::buttonBackgroundGradient(options));
+        guard.setBrush(gradientBrush(Colors::buttonBackgroundGradient(options), options.painter()));
     }  else if (!options.active()) {
-        options.painter()->setBrush(options.color());
+        guard.setBrush(options.color());
     } else {
-        options.painter()->setBrush(Qt::NoBrush);
+        guard.setBrush(Qt::NoBrush);
     }
 
     QRect r(options.rect().right() - options.rect().height(), options.rect().top(), options.rect().height(), options.rect().height());
@@ -965,7 +1393,22 @@ void Renderer::renderSliderHandle(const StyleOptions &options, Side ticks, qreal
     rotate.rotate(angle);
     rotate.translate(-frameRect.center().x(), -frameRect.center().y());
     options.painter()->drawPolygon(circle.toFillPolygon(rotate));
-    options.painter()->restore();
+}
+
+//* largest dial groove kept in the glyph cache
+static const int DialGrooveGlyphSize = 256;
+
+static void drawDialGroove(QPainter *painter, const QRect &rect, const QColor &color)
+{
+    PainterStateGuard guard(painter);
+    guard.setRenderHint(QPainter::Antialiasing, true);
+
+    qreal penWidth(Metrics::Slider_GrooveThickness);
+    QRectF grooveRect(rect.adjusted(penWidth / 2, penWidth / 2, -penWidth / 2, -penWidth / 2));
+
+    guard.setPen(QPen(color, penWidth));
+    guard.setBrush(Qt::NoBrush);
+    painter->drawEllipse(grooveRect);
 }
 
 void Renderer::renderDialGroove(const StyleOptions &options)
@@ -974,23 +1417,33 @@ void Renderer::renderDialGroove(const StyleOptions &options)
         return;
     }
 
-    // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
-
-    QRectF baseRect(options.rect());
-
-    // content
-    if (options.color().isValid()) {
-        qreal penWidth(Metrics::Slider_GrooveThickness);
-        QRectF grooveRect(options.rect().adjusted(penWidth / 2, penWidth / 2, -penWidth / 2, -penWidth / 2));
+    if (!options.color().isValid()) {
+        return;
+    }
 
-        options.painter()->setPen(QPen(options.color(), penWidth));
-        options.painter()->setBrush(Qt::NoBrush);
-        options.painter()->drawEllipse(grooveRect);
+    // the groove does not depend on the dial value, blit it and only stroke the value arc on top
+    const QRect rect(options.rect());
+    if (!rect.isEmpty() && rect.width() <= DialGrooveGlyphSize && rect.height() <= DialGrooveGlyphSize
+            && canUsePixmapCache(options.painter())) {
+        const qreal devicePixelRatio(painterDevicePixelRatio(options.painter()));
+
+        GlyphKey key;
+        key.glyph = GlyphKey::DialGroove;
+        key.size = rect.size();
+        key.color = options.color().rgba();
+        key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+        const QColor color(options.color());
+        const QPixmap *pixmap = glyphPixmap(key, rect.size(), devicePixelRatio, [&](QPainter *painter) {
+            drawDialGroove(painter, QRect(QPoint(0, 0), rect.size()), color);
+        });
+        if (pixmap) {
+            options.painter()->drawPixmap(rect.topLeft(), *pixmap);
+            return;
+        }
     }
 
-    return;
+    drawDialGroove(options.painter(), rect, options.color());
 }
 
 void Renderer::renderDialContents(const StyleOptions &options, qreal first, qreal second)
@@ -1000,7 +1453,8 @@ void Renderer::renderDialContents(const StyleOptions &options, qreal first, qrea
     }
 
     // setup options.painter()
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     QRectF baseRect(options.rect());
 
@@ -1018,45 +1472,79 @@ void Renderer::renderDialContents(const StyleOptions &options, qreal first, qrea
         if (angleSpan != 0) {
             QPen pen(options.color(), penWidth);
             pen.setCapStyle(Qt::RoundCap);
-            options.painter()->setPen(pen);
-            options.painter()->setBrush(Qt::NoBrush);
+            guard.setPen(pen);
+            guard.setBrush(Qt::NoBrush);
             options.painter()->drawArc(grooveRect, angleStart, angleSpan);
         }
     }
-
-    options.painter()->restore();
 }
 
-void Renderer::renderProgressBarGroove(const StyleOptions &options)
-{
-    if (!options.painter()) {
-        return;
-    }
+//* largest progress bar groove kept in the glyph cache, in pixels
+static const int ProgressBarGrooveGlyphArea = 1 << 16;
 
-    // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
-    options.painter()->setRenderHint(QPainter::SmoothPixmapTransform, true);
+static void drawProgressBar(QPainter *painter, const QRect &rect, const QColor &color, const QColor &outlineColor)
+{
+    PainterStateGuard guard(painter);
+    guard.setRenderHint(QPainter::Antialiasing, true);
+    guard.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
-    QRectF baseRect(options.rect());
+    QRectF baseRect(rect);
     qreal radius(0.5);
 
     // content
-    if (options.color().isValid()) {
-        options.painter()->setBrush(options.color());
+    if (color.isValid()) {
+        guard.setBrush(color);
+    }
+    if (outlineColor.isValid()) {
+        guard.setPen(outlineColor);
+    }
+    painter->drawRoundedRect(baseRect.translated(0.5, 0.5), radius, radius);
+}
 
+void Renderer::renderProgressBarGroove(const StyleOptions &options)
+{
+    if (!options.painter()) {
+        return;
     }
-    if (options.outlineColor().isValid()) {
-        options.painter()->setPen(options.outlineColor());
+
+    // the groove does not change with the progress bar value, so it is blitted from a cache.
+    // Only cache it when both colors are set, otherwise the result depends on the painter state
+    const QRect rect(options.rect());
+    if (options.color().isValid() && options.outlineColor().isValid()
+            && !rect.isEmpty() && rect.width() * rect.height() <= ProgressBarGrooveGlyphArea
+            && canUsePixmapCache(options.painter())) {
+        const qreal devicePixelRatio(painterDevicePixelRatio(options.painter()));
+
+        GlyphKey key;
+        key.glyph = GlyphKey::ProgressBarGroove;
+        key.size = rect.size();
+        key.color = options.color().rgba();
+        key.outlineColor = options.outlineColor().rgba();
+        key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+        // the half pixel translation and the pen reach one pixel past the rect
+        const QColor color(options.color());
+        const QColor outlineColor(options.outlineColor());
+        const QPixmap *pixmap = glyphPixmap(key, rect.size() + QSize(1, 1), devicePixelRatio, [&](QPainter *painter) {
+            drawProgressBar(painter, QRect(QPoint(0, 0), rect.size()), color, outlineColor);
+        });
+        if (pixmap) {
+            options.painter()->drawPixmap(rect.topLeft(), *pixmap);
+            return;
+        }
     }
-    options.painter()->drawRoundedRect(baseRect.translated(0.5, 0.5), radius, radius);
 
-    options.painter()->restore();
+    drawProgressBar(options.painter(), rect, options.color(), options.outlineColor());
 }
 
 void Renderer::renderProgressBarContents(const StyleOptions &options)
 {
-    return renderProgressBarGroove(options);
+    if (!options.painter()) {
+        return;
+    }
+
+    // contents change size with every value, they are not worth caching
+    drawProgressBar(options.painter(), options.rect(), options.color(), options.outlineColor());
 }
 
 void Renderer::renderProgressBarBusyContents(const StyleOptions &options, bool horizontal, bool reverse, int progress)
@@ -1068,8 +1556,8 @@ void Renderer::renderProgressBarBusyContents(const StyleOptions &options, bool h
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     QRectF baseRect(options.rect());
     qreal radius(0.25 * Metrics::ProgressBar_Thickness);
@@ -1082,10 +1570,9 @@ void Renderer::renderProgressBarBusyContents(const StyleOptions &options, bool h
         contentRect.translate(0, fabs(progress - 50) / 50.0 * (baseRect.height() - contentRect.height()));
     }
 
-    options.painter()->setBrush(options.color());
-    options.painter()->setPen(options.outlineColor());
+    guard.setBrush(options.color());
+    guard.setPen(options.outlineColor());
     options.painter()->drawRoundedRect(contentRect.translated(0.5, 0.5), radius, radius);
-    options.painter()->restore();
 }
 
 void Renderer::renderScrollBarGroove(const StyleOptions &options)
@@ -1100,8 +1587,8 @@ void Renderer::renderScrollBarHandle(const StyleOptions &options)
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, true);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, true);
 
     QRectF baseRect(options.rect());
     qreal metric(options.rect().width() < options.rect().height() ? options.rect().width() : options.rect().height());
@@ -1109,12 +1596,10 @@ void Renderer::renderScrollBarHandle(const StyleOptions &options)
 
     // content
     if (options.color().isValid()) {
-        options.painter()->setPen(Qt::NoPen);
-        options.painter()->setBrush(options.color());
+        guard.setPen(Qt::NoPen);
+        guard.setBrush(options.color());
         options.painter()->drawRoundedRect(baseRect, radius, radius);
     }
-
-    options.painter()->restore();
 }
 
 void Renderer::renderToolBarHandle(const StyleOptions &options)
@@ -1129,19 +1614,19 @@ void Renderer::renderTabBarTab(const StyleOptions &options, const QColor &backgr
     }
 
     // setup options.painter()
-    options.painter()->save();
-    options.painter()->setRenderHint(QPainter::Antialiasing, false);
+    PainterStateGuard guard(options.painter());
+    guard.setRenderHint(QPainter::Antialiasing, false);
 
     QRectF frameRect(options.rect());
-    qreal adjustment;
+    qreal adjustment(0);
 
     // pen
     if (options.outlineColor().isValid()) {
-        options.painter()->setPen(options.outlineColor());
+        guard.setPen(options.outlineColor());
         frameRect.adjust(1.0, 1.0, -1.0, -1.0);
         adjustment = 0;
 
-        options.painter()->setBrush(background);
+        guard.setBrush(background);
 
         // render
         options.painter()->drawRect(frameRect);
@@ -1149,7 +1634,7 @@ void Renderer::renderTabBarTab(const StyleOptions &options, const QColor &backgr
         adjustment = 9;
     }
 
-    options.painter()->setPen(QPen(options.color(), 6));
+    guard.setPen(QPen(options.color(), 6));
 
     switch (corners) {
     case CornersTop:
@@ -1165,16 +1650,16 @@ void Renderer::renderTabBarTab(const StyleOptions &options, const QColor &backgr
         options.painter()->drawLine(frameRect.left(), frameRect.top() + adjustment, frameRect.left(), frameRect.bottom() - adjustment);
         break;
     }
-
-    options.painter()->restore();
 }
 
-void Renderer::renderArrow(const StyleOptions &options, ArrowOrientation arrowOrientation)
-{
-    if (!options.painter()) {
-        return;
-    }
+//* size of the pixmap holding one arrow glyph, before center alignment
+static const int ArrowGlyphSize = 12;
 
+//* size of the pixmap holding one sign glyph
+static const int SignGlyphSize = 14;
+
+static void drawArrow(QPainter *painter, const QPointF &center, const QColor &color, ArrowOrientation arrowOrientation)
+{
     // define polygon
     QPolygonF arrow;
     switch (arrowOrientation) {
@@ -1194,90 +1679,195 @@ void Renderer::renderArrow(const StyleOptions &options, ArrowOrientation arrowOr
         break;
     }
 
-    QPen pen(options.color(), 1.2);
+    QPen pen(color, 1.2);
     pen.setCapStyle(Qt::FlatCap);
     pen.setJoinStyle(Qt::MiterJoin);
 
-    options.painter()->save();
-    options.painter()->setRenderHints(QPainter::Antialiasing);
-    options.painter()->translate(QRectF(options.rect()).center());
-    options.painter()->setBrush(options.color());
-    options.painter()->setPen(pen);
-    options.painter()->drawPolygon(arrow);
+    PainterStateGuard guard(painter);
+    guard.setRenderHints(QPainter::Antialiasing);
+    guard.translate(center);
+    guard.setBrush(color);
+    guard.setPen(pen);
+    painter->drawPolygon(arrow);
+}
 
-    options.painter()->restore();
+//* arrows only depend on whether the rect center falls on a pixel boundary, not on the rect size
+static const QPixmap *arrowGlyph(ArrowOrientation arrowOrientation, const QColor &color, bool oddWidth, bool oddHeight, qreal devicePixelRatio)
+{
+    GlyphKey key;
+    key.glyph = GlyphKey::Arrow;
+    key.variant = arrowOrientation;
+    key.size = QSize(oddWidth, oddHeight);
+    key.color = color.rgba();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+    const QRectF rect(0, 0, ArrowGlyphSize + oddWidth, ArrowGlyphSize + oddHeight);
+    return glyphPixmap(key, rect.size().toSize(), devicePixelRatio, [&](QPainter *painter) {
+        drawArrow(painter, rect.center(), color, arrowOrientation);
+    });
 }
 
-void Renderer::renderSign(const StyleOptions &options, bool orientation)
+void Renderer::renderArrow(const StyleOptions &options, ArrowOrientation arrowOrientation)
 {
     if (!options.painter()) {
         return;
     }
 
-    QPen pen(options.color(), 2);
-    pen.setCapStyle(Qt::FlatCap);
+    const QRect rect(options.rect());
+    if (canUsePixmapCache(options.painter())) {
+        const bool oddWidth(rect.width() & 1);
+        const bool oddHeight(rect.height() & 1);
+        if (const QPixmap *pixmap = arrowGlyph(arrowOrientation, options.color(), oddWidth, oddHeight, painterDevicePixelRatio(options.painter()))) {
+            options.painter()->drawPixmap(QPoint(rect.left() + (rect.width() - ArrowGlyphSize - oddWidth) / 2,
+                                                 rect.top() + (rect.height() - ArrowGlyphSize - oddHeight) / 2),
+                                          *pixmap);
+            return;
+        }
+    }
+
+    drawArrow(options.painter(), QRectF(rect).center(), options.color(), arrowOrientation);
+}
 
-    QRect r = options.rect().adjusted(1, 2, 0, 0);
+static void drawSign(QPainter *painter, const QPoint &center, const QColor &color, bool orientation)
+{
+    QPen pen(color, 2);
+    pen.setCapStyle(Qt::FlatCap);
 
-    options.painter()->save();
-    options.painter()->setPen(pen);
-    options.painter()->drawLine(r.center() - QPointF(5, 0), r.center() + QPointF(5, 0));
+    PainterStateGuard guard(painter);
+    guard.setPen(pen);
+    painter->drawLine(center - QPointF(5, 0), center + QPointF(5, 0));
     if (orientation) {
-        options.painter()->drawLine(r.center() - QPointF(0, 5), r.center() + QPointF(0, 5));
+        painter->drawLine(center - QPointF(0, 5), center + QPointF(0, 5));
     }
-    options.painter()->restore();
 }
 
-void Renderer::renderDecorationButton(const StyleOptions &options, ButtonType buttonType)
+static const QPixmap *signGlyph(bool orientation, const QColor &color, bool antialiasing, qreal devicePixelRatio)
+{
+    GlyphKey key;
+    key.glyph = GlyphKey::Sign;
+    key.variant = orientation;
+    key.color = color.rgba();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+    key.antialiasing = antialiasing;
+
+    return glyphPixmap(key, QSize(SignGlyphSize, SignGlyphSize), devicePixelRatio, [&](QPainter *painter) {
+        painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+        drawSign(painter, QPoint(SignGlyphSize / 2, SignGlyphSize / 2), color, orientation);
+    });
+}
+
+void Renderer::renderSign(const StyleOptions &options, bool orientation)
 {
     if (!options.painter()) {
         return;
     }
 
-    options.painter()->save();
-    options.painter()->setViewport(options.rect());
-    options.painter()->setWindow(0, 0, 18, 18);
-    options.painter()->setRenderHints(QPainter::Antialiasing, false);
+    const QPoint center(options.rect().adjusted(1, 2, 0, 0).center());
+    if (canUsePixmapCache(options.painter())) {
+        const bool antialiasing(options.painter()->testRenderHint(QPainter::Antialiasing));
+        if (const QPixmap *pixmap = signGlyph(orientation, options.color(), antialiasing, painterDevicePixelRatio(options.painter()))) {
+            options.painter()->drawPixmap(center - QPoint(SignGlyphSize / 2, SignGlyphSize / 2), *pixmap);
+            return;
+        }
+    }
+
+    drawSign(options.painter(), center, options.color(), orientation);
+}
+
+static void drawDecorationButton(QPainter *painter, const QRect &rect, const QColor &color, ButtonType buttonType)
+{
+    PainterStateGuard guard(painter);
+    guard.setViewport(rect);
+    guard.setWindow(0, 0, 18, 18);
+    guard.setRenderHints(QPainter::Antialiasing, false);
 
     // initialize pen
     QPen pen;
     pen.setCapStyle(Qt::RoundCap);
     pen.setJoinStyle(Qt::MiterJoin);
 
-    options.painter()->setBrush(Qt::NoBrush);
+    guard.setBrush(Qt::NoBrush);
 
-    pen.setColor(options.color());
+    pen.setColor(color);
     pen.setCapStyle(Qt::RoundCap);
     pen.setJoinStyle(Qt::MiterJoin);
-    pen.setWidthF(2.0 * qMax(1.0, 18.0 / options.rect().width()));
-    options.painter()->setPen(pen);
+    pen.setWidthF(2.0 * qMax(1.0, 18.0 / rect.width()));
+    guard.setPen(pen);
 
     switch (buttonType) {
     case ButtonClose: {
-        options.painter()->setRenderHints(QPainter::Antialiasing, true);
-        options.painter()->drawLine(QPointF(5, 5), QPointF(13, 13));
-        options.painter()->drawLine(13, 5, 5, 13);
+        guard.setRenderHints(QPainter::Antialiasing, true);
+        painter->drawLine(QPointF(5, 5), QPointF(13, 13));
+        painter->drawLine(13, 5, 5, 13);
         break;
     }
     case ButtonMaximize: {
-        options.painter()->drawRect(5, 5, 8, 8);
+        painter->drawRect(5, 5, 8, 8);
         break;
     }
     case ButtonMinimize: {
-        options.painter()->drawPolyline(QPolygonF()
+        painter->drawPolyline(QPolygonF()
                               << QPointF(5, 13)
                               << QPointF(13, 13));
         break;
     }
     case ButtonRestore: {
-        options.painter()->drawRect(6, 6, 6, 6);
+        painter->drawRect(6, 6, 6, 6);
         break;
     }
     default:
         break;
     }
+}
+
+void Renderer::renderDecorationButton(const StyleOptions &options, ButtonType buttonType)
+{
+    if (!options.painter()) {
+        return;
+    }
 
-    options.painter()->restore();
+    // the viewport set when painting does not compose with translations, so only plain painters use the cache
+    const QRect rect(options.rect());
+    if (!rect.isEmpty() && canUsePixmapCache(options.painter(), QTransform::TxNone)) {
+        const qreal devicePixelRatio(painterDevicePixelRatio(options.painter()));
+        const QColor color(options.color());
+
+        GlyphKey key;
+        key.glyph = GlyphKey::DecorationButton;
+        key.variant = buttonType;
+        key.size = rect.size();
+        key.color = color.rgba();
+        key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+        const QPixmap *pixmap(glyphPixmap(key, rect.size(), devicePixelRatio, [&](QPainter *painter) {
+            drawDecorationButton(painter, QRect(QPoint(0, 0), rect.size()), color, buttonType);
+        }));
+
+        if (pixmap) {
+            options.painter()->drawPixmap(rect.topLeft(), *pixmap);
+            return;
+        }
+    }
+
+    drawDecorationButton(options.painter(), rect, options.color(), buttonType);
+}
+
+void Renderer::prewarmGlyphs(const QColor &color, qreal devicePixelRatio)
+{
+    if (!canUsePixmaps()) {
+        return;
+    }
+
+    const ArrowOrientation orientations[] = { ArrowUp, ArrowDown, ArrowLeft, ArrowRight };
+    for (ArrowOrientation orientation : orientations) {
+        for (int alignment = 0; alignment < 4; ++alignment) {
+            arrowGlyph(orientation, color, alignment & 1, alignment & 2, devicePixelRatio);
+        }
+    }
+
+    for (int sign = 0; sign < 4; ++sign) {
+        signGlyph(sign & 1, color, sign & 2, devicePixelRatio);
+    }
 }
 
 } // namespace Adwaita
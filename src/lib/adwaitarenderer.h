@@ -31,6 +31,33 @@ namespace Adwaita
 class ADWAITAQT_MAIN_EXPORT Renderer
 {
 public:
+    //* hit and size counters of a renderer cache
+    struct CacheStatistics {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        int count = 0;
+        int maxCount = 0;
+
+        //* number of cached items
+        int entries = 0;
+
+        //* memory held by cached items, in bytes. An estimate for non pixmap caches
+        qint64 bytes = 0;
+    };
+
+    //* usage of the cache holding frame and tab paths
+    /** computing bytes walks the cache, which is fine for diagnostics but not for every frame */
+    static CacheStatistics pathCacheStatistics();
+
+    //* usage of the cache holding arrows, signs, grooves and gradient strips. Counts are in pixels
+    static CacheStatistics glyphCacheStatistics();
+
+    //* usage of the cache holding check box and radio button sprites. Counts are in pixels
+    static CacheStatistics indicatorSpriteCacheStatistics();
+
+    //* reset hit and miss counters of all caches
+    static void resetCacheStatistics();
+
     static void renderDebugFrame(const StyleOptions &options);
 
     static void renderFocusRect(const StyleOptions &options, Sides sides = SideNone);
@@ -100,6 +127,9 @@ public:
     static void renderSign(const StyleOptions &options, bool orientation);
 
     static void renderDecorationButton(const StyleOptions &options, ButtonType buttonType);
+
+    //* renders arrow and sign glyphs of a given color ahead of time, so that their first paint is a blit
+    static void prewarmGlyphs(const QColor &color, qreal devicePixelRatio = 1.0);
 };
 
 } // namespace Adwaita
@@ -0,0 +1,245 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_RENDERER_P_H
+#define ADWAITA_RENDERER_P_H
+
+#include "adwaita.h"
+
+#include <QBitArray>
+#include <QCache>
+#include <QColor>
+#include <QCoreApplication>
+#include <QHash>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QSize>
+#include <QThread>
+
+namespace Adwaita
+{
+
+#if QT_VERSION >= 0x060000
+using HashValue = size_t;
+#else
+using HashValue = uint;
+#endif
+
+//* combined hash of the integer fields a cache key depends on
+template<typename... T>
+inline HashValue hashValues(HashValue seed, const T &...values)
+{
+#if QT_VERSION >= 0x060000
+    return qHashMulti(seed, values...);
+#else
+    const uint hashes[] = { uint(values)... };
+    return qHashRange(hashes, hashes + sizeof...(T), seed);
+#endif
+}
+
+//* pixmaps are only safe to use from the gui thread
+inline bool canUsePixmaps()
+{
+    return QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+//* true if cached pixmaps can be blitted with painter rather than painting directly
+/**
+ * a cached pixmap, or a path flattened at device resolution, only matches direct painting
+ * when the painter transform is no more than maxTransform. Callers still check the size
+ * of what they cache
+ */
+inline bool canUsePixmapCache(const QPainter *painter, QTransform::TransformationType maxTransform = QTransform::TxTranslate)
+{
+    return painter->transform().type() <= maxTransform && canUsePixmaps();
+}
+
+//* everything a checkbox or radio button indicator depends on, except its state
+struct IndicatorSpriteKey {
+    enum Type {
+        CheckBox,
+        RadioButton
+    };
+
+    enum Flag {
+        Active = 1 << 0,
+        Sunken = 1 << 1,
+        MouseOver = 1 << 2,
+        InMenu = 1 << 3,
+        Disabled = 1 << 4,
+        ColorValid = 1 << 5,
+        OutlineColorValid = 1 << 6,
+        TickColorValid = 1 << 7
+    };
+
+    int type = CheckBox;
+    QSize size;
+    int variant = 0;
+
+    //* device pixel ratio, in percent
+    int devicePixelRatio = 100;
+
+    QRgb color = 0;
+    QRgb outlineColor = 0;
+    QRgb tickColor = 0;
+    int flags = 0;
+
+    bool operator==(const IndicatorSpriteKey &other) const
+    {
+        return type == other.type
+               && size == other.size
+               && variant == other.variant
+               && devicePixelRatio == other.devicePixelRatio
+               && color == other.color
+               && outlineColor == other.outlineColor
+               && tickColor == other.tickColor
+               && flags == other.flags;
+    }
+};
+
+HashValue qHash(const IndicatorSpriteKey &key, HashValue seed = 0);
+
+//* horizontal strip of indicator frames: static states followed by quantized animation steps
+/** frames are rendered lazily, the first time they are needed */
+struct IndicatorSpriteSheet {
+    enum Frame {
+        FrameOff,
+        FrameOn,
+        FramePartial,
+        FrameAnimated,
+        FrameCount = FrameAnimated + Config::AnimationSteps + 1
+    };
+
+    QPixmap pixmap;
+
+    //* width of one frame, in device pixels
+    int frameWidth = 0;
+
+    //* frames already rendered
+    QBitArray ready;
+};
+
+//* everything a cached glyph or static control part depends on
+struct GlyphKey {
+    enum Glyph {
+        Arrow,
+        Sign,
+        DecorationButton,
+        DialGroove,
+        ProgressBarGroove,
+        GradientStrip
+    };
+
+    int glyph = Arrow;
+
+    //* arrow orientation, sign orientation or button type
+    int variant = 0;
+
+    //* pixmap size, or center alignment for glyphs that do not scale
+    QSize size;
+
+    QRgb color = 0;
+
+    //* outline color, for glyphs that have one. Bottom color for gradient strips
+    QRgb outlineColor = 0;
+
+    //* device pixel ratio, in percent
+    int devicePixelRatio = 100;
+
+    //* glyphs that inherit the painter antialiasing hint
+    bool antialiasing = false;
+
+    bool operator==(const GlyphKey &other) const
+    {
+        return glyph == other.glyph
+               && variant == other.variant
+               && size == other.size
+               && color == other.color
+               && outlineColor == other.outlineColor
+               && devicePixelRatio == other.devicePixelRatio
+               && antialiasing == other.antialiasing;
+    }
+};
+
+HashValue qHash(const GlyphKey &key, HashValue seed = 0);
+
+//* everything a cached path depends on. Lengths are stored in quarter pixels
+struct PathKey {
+    enum Shape {
+        RoundedRect,
+        LeftRoundedRect,
+        RightRoundedRect,
+        ToolBoxFrame
+    };
+
+    int shape = RoundedRect;
+    QSize size;
+    int radius = 0;
+
+    //* corners for rounded rects, tab width for toolbox frames
+    int extra = 0;
+
+    //* device pixel ratio, in percent
+    int devicePixelRatio = 100;
+
+    bool operator==(const PathKey &other) const
+    {
+        return shape == other.shape
+               && size == other.size
+               && radius == other.radius
+               && extra == other.extra
+               && devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+HashValue qHash(const PathKey &key, HashValue seed = 0);
+
+class RendererPrivate
+{
+public:
+    //* max number of pixels held by indicator sprite sheets
+    enum { IndicatorSpriteCost = 1 << 21 };
+
+    //* max number of pixels held by glyphs
+    enum { GlyphCost = 1 << 20 };
+
+    //* max number of cached paths
+    enum { PathCount = 512 };
+
+    RendererPrivate();
+
+    QCache<IndicatorSpriteKey, IndicatorSpriteSheet> indicatorSprites;
+    quint64 indicatorSpriteHits = 0;
+    quint64 indicatorSpriteMisses = 0;
+
+    QCache<GlyphKey, QPixmap> glyphs;
+    quint64 glyphHits = 0;
+    quint64 glyphMisses = 0;
+
+    QCache<PathKey, QPainterPath> paths;
+    quint64 pathHits = 0;
+    quint64 pathMisses = 0;
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_RENDERER_P_H
@@ -0,0 +1,128 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitaruntimeconfig.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace Adwaita
+{
+
+//____________________________________________________________________
+RuntimeConfig::RuntimeConfig(QObject *parent)
+    : QObject(parent)
+{
+    _fileName = QString::fromLocal8Bit(qgetenv("ADWAITA_CONFIG"));
+    if (_fileName.isEmpty()) {
+        _fileName = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QStringLiteral("/adwaita-qt/adwaita.conf");
+    }
+
+    _values = read();
+
+    connect(&_watcher, &QFileSystemWatcher::fileChanged, this, &RuntimeConfig::reload);
+    connect(&_watcher, &QFileSystemWatcher::directoryChanged, this, &RuntimeConfig::reload);
+    watch();
+}
+
+//____________________________________________________________________
+void RuntimeConfig::reload()
+{
+    // editors often replace the file rather than writing to it, which drops the watch
+    watch();
+
+    const Values values(read());
+    if (values == _values) {
+        return;
+    }
+
+    _values = values;
+    Q_EMIT changed();
+}
+
+//____________________________________________________________________
+RuntimeConfig::Values RuntimeConfig::read() const
+{
+    Values values;
+    if (!QFileInfo::exists(_fileName)) {
+        return values;
+    }
+
+    QSettings settings(_fileName, QSettings::IniFormat);
+    auto readGroup = [&settings, &values]() {
+        values.animationsEnabled = settings.value(QStringLiteral("AnimationsEnabled"), values.animationsEnabled).toBool();
+        values.animationsDuration = settings.value(QStringLiteral("AnimationsDuration"), values.animationsDuration).toInt();
+        values.stackedWidgetTransitionsEnabled = settings.value(QStringLiteral("StackedWidgetTransitionsEnabled"), values.stackedWidgetTransitionsEnabled).toBool();
+        values.progressBarAnimated = settings.value(QStringLiteral("ProgressBarAnimated"), values.progressBarAnimated).toBool();
+        values.progressBarBusyStepDuration = settings.value(QStringLiteral("ProgressBarBusyStepDuration"), values.progressBarBusyStepDuration).toInt();
+        values.splitterProxyEnabled = settings.value(QStringLiteral("SplitterProxyEnabled"), values.splitterProxyEnabled).toBool();
+    };
+
+    // keys shared by all applications, then the application's own section
+    readGroup();
+
+    const QString application(QCoreApplication::applicationName());
+    if (!application.isEmpty() && settings.childGroups().contains(application)) {
+        settings.beginGroup(application);
+        readGroup();
+        settings.endGroup();
+    }
+
+    // durations drive timers, keep them sane
+    values.animationsDuration = qMax(0, values.animationsDuration);
+    values.progressBarBusyStepDuration = qMax(1, values.progressBarBusyStepDuration);
+    return values;
+}
+
+//____________________________________________________________________
+void RuntimeConfig::watch()
+{
+    if (QFileInfo::exists(_fileName) && !_watcher.files().contains(_fileName)) {
+        _watcher.addPath(_fileName);
+    }
+
+    // the file directory, or its nearest existing ancestor until the directory gets created
+    QString directory(QFileInfo(_fileName).absolutePath());
+    while (!QFileInfo::exists(directory)) {
+        const QString parent(QFileInfo(directory).absolutePath());
+        if (parent == directory) {
+            break;
+        }
+
+        directory = parent;
+    }
+
+    // stop watching ancestors once a directory closer to the file exists
+    const QStringList directories(_watcher.directories());
+    for (const QString &watched : directories) {
+        if (watched != directory) {
+            _watcher.removePath(watched);
+        }
+    }
+
+    if (QFileInfo::exists(directory) && !directories.contains(directory)) {
+        _watcher.addPath(directory);
+    }
+}
+
+} // namespace Adwaita
@@ -0,0 +1,148 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_RUNTIME_CONFIG_H
+#define ADWAITA_RUNTIME_CONFIG_H
+
+#include "adwaita.h"
+#include "adwaitaqt_export.h"
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+
+namespace Adwaita
+{
+
+//* runtime overrides for the performance related Config constants
+/**
+ * values are read from adwaita-qt/adwaita.conf in the XDG config directory, or from the file
+ * ADWAITA_CONFIG points to. Keys at the top of the file apply to every application, and a
+ * section named after an application overrides them for that application only, for instance
+ *
+ *  AnimationsEnabled=true
+ *  [krita]
+ *  AnimationsEnabled=false
+ *
+ * The file is watched, and changed() is emitted when an edit changes the values in effect
+ */
+class ADWAITAQT_EXPORT RuntimeConfig : public QObject
+{
+    Q_OBJECT
+
+public:
+    //* constructor
+    explicit RuntimeConfig(QObject *parent);
+
+    //* destructor
+    virtual ~RuntimeConfig()
+    {
+    }
+
+    //* configuration file
+    QString fileName() const
+    {
+        return _fileName;
+    }
+
+    //*@name values in effect for this application
+    //@{
+
+    bool animationsEnabled() const
+    {
+        return _values.animationsEnabled;
+    }
+
+    int animationsDuration() const
+    {
+        return _values.animationsDuration;
+    }
+
+    bool stackedWidgetTransitionsEnabled() const
+    {
+        return _values.stackedWidgetTransitionsEnabled;
+    }
+
+    bool progressBarAnimated() const
+    {
+        return _values.progressBarAnimated;
+    }
+
+    int progressBarBusyStepDuration() const
+    {
+        return _values.progressBarBusyStepDuration;
+    }
+
+    bool splitterProxyEnabled() const
+    {
+        return _values.splitterProxyEnabled;
+    }
+
+    //@}
+
+Q_SIGNALS:
+    //* emitted when the file changes one of the values in effect
+    void changed();
+
+private Q_SLOTS:
+    //* read the file again, emit changed() if needed
+    void reload();
+
+private:
+    //* values, defaulting to the compile time ones
+    struct Values {
+        bool animationsEnabled = Config::AnimationsEnabled;
+        int animationsDuration = Config::AnimationsDuration;
+        bool stackedWidgetTransitionsEnabled = Config::StackedWidgetTransitionsEnabled;
+        bool progressBarAnimated = Config::ProgressBarAnimated;
+        int progressBarBusyStepDuration = Config::ProgressBarBusyStepDuration;
+        bool splitterProxyEnabled = Config::SplitterProxyEnabled;
+
+        bool operator==(const Values &other) const
+        {
+            return animationsEnabled == other.animationsEnabled
+                   && animationsDuration == other.animationsDuration
+                   && stackedWidgetTransitionsEnabled == other.stackedWidgetTransitionsEnabled
+                   && progressBarAnimated == other.progressBarAnimated
+                   && progressBarBusyStepDuration == other.progressBarBusyStepDuration
+                   && splitterProxyEnabled == other.splitterProxyEnabled;
+        }
+    };
+
+    //* read values from the file, or return the defaults if there is none
+    Values read() const;
+
+    //* watch the file, and its directory or nearest existing ancestor in case either gets created or replaced
+    void watch();
+
+    //* configuration file
+    QString _fileName;
+
+    //* values in effect
+    Values _values;
+
+    //* file watcher
+    QFileSystemWatcher _watcher;
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_RUNTIME_CONFIG_H
@@ -62,6 +62,12 @@ public:
     //* unregister widget
     void unregisterWidget(QWidget *);
 
+    //* number of registered widgets, each with its proxy
+    int proxyCount() const
+    {
+        return _widgets.size();
+    }
+
 private:
     //* enabled state
     bool _enabled;
@@ -0,0 +1,138 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+namespace Adwaita
+{
+
+//* buffered events are written out past this size
+static const int TraceBufferSize = 1 << 20;
+
+//* trace file and clock
+class TracerPrivate
+{
+public:
+    TracerPrivate();
+    ~TracerPrivate();
+
+    //* write buffer to file. Must be called with the mutex locked
+    void flush();
+
+    QMutex mutex;
+    QFile file;
+    QByteArray buffer;
+    QElapsedTimer clock;
+    qint64 pid = 0;
+    bool firstEvent = true;
+};
+
+Q_GLOBAL_STATIC(TracerPrivate, tracerGlobal)
+
+const bool Tracer::_enabled = !qEnvironmentVariableIsEmpty("ADWAITA_TRACE");
+
+//______________________________________________________________
+TracerPrivate::TracerPrivate()
+    : file(qEnvironmentVariable("ADWAITA_TRACE"))
+{
+    clock.start();
+    pid = QCoreApplication::applicationPid();
+    buffer.reserve(TraceBufferSize);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Adwaita::Tracer - cannot open" << file.fileName() << ":" << file.errorString();
+        return;
+    }
+
+    buffer.append("[\n");
+}
+
+//______________________________________________________________
+TracerPrivate::~TracerPrivate()
+{
+    if (file.isOpen()) {
+        buffer.append("\n]\n");
+        flush();
+    }
+}
+
+//______________________________________________________________
+void TracerPrivate::flush()
+{
+    if (file.isOpen()) {
+        file.write(buffer);
+        file.flush();
+    }
+
+    buffer.clear();
+}
+
+//______________________________________________________________
+qint64 Tracer::timestamp()
+{
+    const TracerPrivate *d(tracerGlobal);
+    return d ? d->clock.nsecsElapsed() : 0;
+}
+
+//______________________________________________________________
+void Tracer::addEvent(const char *category, const char *name, const QObject *object, const QSize &size, qint64 start, qint64 duration)
+{
+    TracerPrivate *d(tracerGlobal);
+    if (!d) {
+        return;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    if (!d->file.isOpen()) {
+        return;
+    }
+
+    if (!d->firstEvent) {
+        d->buffer.append(",\n");
+    }
+
+    d->firstEvent = false;
+
+    // timestamps are in microseconds
+    d->buffer.append("{\"ph\":\"X\",\"cat\":\"").append(category)
+        .append("\",\"name\":\"").append(name ? name : "Custom")
+        .append("\",\"pid\":").append(QByteArray::number(d->pid))
+        .append(",\"tid\":").append(QByteArray::number(qulonglong(quintptr(QThread::currentThreadId()))))
+        .append(",\"ts\":").append(QByteArray::number(start / 1000.0, 'f', 3))
+        .append(",\"dur\":").append(QByteArray::number(duration / 1000.0, 'f', 3))
+        .append(",\"args\":{\"class\":\"").append(object ? object->metaObject()->className() : "")
+        .append("\",\"width\":").append(QByteArray::number(size.width()))
+        .append(",\"height\":").append(QByteArray::number(size.height()))
+        .append("}}");
+
+    if (d->buffer.size() >= TraceBufferSize) {
+        d->flush();
+    }
+}
+
+} // namespace Adwaita
@@ -0,0 +1,99 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_TRACER_H
+#define ADWAITA_TRACER_H
+
+#include "adwaitaqt_export.h"
+
+#include <QMetaEnum>
+#include <QObject>
+#include <QSize>
+
+namespace Adwaita
+{
+
+//* chrome trace event writer
+/**
+ * when ADWAITA_TRACE is set to a file name, style calls and animation ticks are written there
+ * as complete events in the chrome trace event format, which chrome://tracing and the Perfetto
+ * ui can open. When it is not set, events cost one test of a constant flag
+ */
+class ADWAITAQT_EXPORT Tracer
+{
+public:
+    //* true if tracing
+    static bool enabled()
+    {
+        return _enabled;
+    }
+
+    //* enum value name, only resolved when tracing
+    template<typename Enum>
+    static const char *name(Enum value)
+    {
+        return _enabled ? QMetaEnum::fromType<Enum>().valueToKey(value) : nullptr;
+    }
+
+    //* scoped complete event
+    class Event
+    {
+    public:
+        Event(const char *category, const char *name, const QObject *object, const QSize &size = QSize())
+            : _start(_enabled ? timestamp() : -1)
+            , _category(category)
+            , _name(name)
+            , _object(object)
+            , _size(size)
+        {
+        }
+
+        ~Event()
+        {
+            if (_start >= 0) {
+                addEvent(_category, _name, _object, _size, _start, timestamp() - _start);
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Event)
+
+        qint64 _start;
+        const char *_category;
+        const char *_name;
+        const QObject *_object;
+        QSize _size;
+    };
+
+private:
+    //* nanoseconds since tracing started
+    static qint64 timestamp();
+
+    //* write complete event
+    static void addEvent(const char *category, const char *name, const QObject *object, const QSize &size, qint64 start, qint64 duration);
+
+    //* set once, from the environment
+    static const bool _enabled;
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_TRACER_H
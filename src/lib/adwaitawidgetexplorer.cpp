@@ -25,20 +25,104 @@
 
 #include <QTextStream>
 #include <QApplication>
+#include <QKeyEvent>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
 
 Q_LOGGING_CATEGORY(ADWAITA, "adwaita.widgetexplorer")
+Q_LOGGING_CATEGORY(ADWAITA_WATCHDOG, "adwaita.watchdog")
 
 namespace Adwaita
 {
 
+//* number of recent samples kept for percentiles
+static const int ProfileSampleCount = 4096;
+
+//* number of entries listed per section of a slow frame breakdown
+static const int FrameEntryCount = 10;
+
+//* size of the overdraw heat map cells, in pixels
+static const int OverdrawTileSize = 8;
+
+//* translucent layer over a window, showing how many times each area was painted
+class OverdrawOverlay : public QWidget
+{
+public:
+    //* constructor. The overlay is parented by the caller, once registered
+    explicit OverdrawOverlay(WidgetExplorer *explorer)
+        : _explorer(explorer)
+    {
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+        setAttribute(Qt::WA_NoSystemBackground);
+        setFocusPolicy(Qt::NoFocus);
+    }
+
+protected:
+    //* overlays are painted after the widgets below them, so the tiles hold the whole frame
+    virtual void paintEvent(QPaintEvent *event)
+    {
+        auto iter(_explorer->_overdraw.find(parentWidget()));
+        if (iter == _explorer->_overdraw.end() || iter->size.isEmpty()) {
+            return;
+        }
+
+        WidgetExplorer::OverdrawGrid &grid(*iter);
+        QPainter painter(this);
+        for (const QRect &rect : event->region()) {
+            const int left(qMax(0, rect.left() / OverdrawTileSize));
+            const int right(qMin(grid.size.width() - 1, rect.right() / OverdrawTileSize));
+            const int top(qMax(0, rect.top() / OverdrawTileSize));
+            const int bottom(qMin(grid.size.height() - 1, rect.bottom() / OverdrawTileSize));
+            for (int row = top; row <= bottom; ++row) {
+                for (int column = left; column <= right; ++column) {
+                    quint16 &layers(grid.layers[row * grid.size.width() + column]);
+                    if (layers >= 2) {
+                        painter.fillRect(QRect(column * OverdrawTileSize, row * OverdrawTileSize, OverdrawTileSize, OverdrawTileSize), color(layers));
+                    }
+
+                    // next frame starts from scratch
+                    layers = 0;
+                }
+            }
+        }
+    }
+
+private:
+    //* heat map color for number of layers
+    static QColor color(int layers)
+    {
+        switch (layers) {
+        case 2:
+            return QColor(0, 200, 0, 80);
+        case 3:
+            return QColor(220, 220, 0, 100);
+        case 4:
+            return QColor(255, 140, 0, 120);
+        default:
+            return QColor(255, 0, 0, 140);
+        }
+    }
+
+    WidgetExplorer *_explorer;
+};
+
 //________________________________________________
 WidgetExplorer::WidgetExplorer(QObject *parent)
     : QObject(parent)
     , _enabled(false)
     , _drawWidgetRects(false)
+    , _drawOverdraw(false)
+    , _profiling(false)
+    , _paintStart(0)
+    , _markerPosted(false)
+    , _frameBudget(0)
+    , _frameStart(-1)
 {
+    _clock.start();
+
     _eventTypes.insert(QEvent::Enter, QStringLiteral("Enter"));
     _eventTypes.insert(QEvent::Leave, QStringLiteral("Leave"));
 
@@ -54,6 +138,17 @@ WidgetExplorer::WidgetExplorer(QObject *parent)
     _eventTypes.insert(QEvent::FocusOut, QStringLiteral("FocusOut"));
 
     // _eventTypes.insert( QEvent::Paint, "Paint" );
+
+    // paint profiling, with a report on exit
+    if (!qEnvironmentVariableIsEmpty("ADWAITA_PROFILE") && qEnvironmentVariable("ADWAITA_PROFILE") != QLatin1String("0")) {
+        setProfiling(true);
+        if (qApp) {
+            connect(qApp, &QCoreApplication::aboutToQuit, this, &WidgetExplorer::dumpProfile);
+        }
+    }
+
+    // slow frame watchdog
+    setFrameBudget(qEnvironmentVariableIntValue("ADWAITA_FRAME_BUDGET"));
 }
 
 //________________________________________________
@@ -64,11 +159,249 @@ void WidgetExplorer::setEnabled(bool value)
     }
 
     _enabled = value;
+    updateEventFilter();
+}
+
+//________________________________________________
+void WidgetExplorer::setDrawOverdraw(bool value)
+{
+    if (value == _drawOverdraw) {
+        return;
+    }
+
+    _drawOverdraw = value;
+    if (!_drawOverdraw) {
+        const auto overlays(_overlays);
+        for (const QPointer<QWidget> &overlay : overlays) {
+            delete overlay.data();
+        }
+
+        _overlays.clear();
+        _overdraw.clear();
+    } else {
+        // windows already on screen get their overlay right away
+        const auto windows(QApplication::topLevelWidgets());
+        for (QWidget *window : windows) {
+            if (window->isVisible()) {
+                updateOverlay(window);
+            }
+        }
+    }
+
+    updateEventFilter();
+}
+
+//________________________________________________
+void WidgetExplorer::setProfiling(bool value)
+{
+    if (value == _profiling) {
+        return;
+    }
+
+    _profiling = value;
+    updateEventFilter();
+}
+
+//________________________________________________
+void WidgetExplorer::setFrameBudget(int value)
+{
+    value = qMax(value, 0);
+    if (value == _frameBudget) {
+        return;
+    }
+
+    _frameBudget = value;
+    updateEventFilter();
+}
+
+//________________________________________________
+void WidgetExplorer::updateEventFilter()
+{
+    if (!qApp) {
+        return;
+    }
 
     qApp->removeEventFilter(this);
-    if (_enabled) {
+    if (_enabled || _drawOverdraw || timing()) {
         qApp->installEventFilter(this);
     }
+
+    // drop measurements the filter can no longer end. A marker still on its way is harmless
+    if (!timing()) {
+        _paintedClass.clear();
+        _frameWindow.clear();
+        _frameStart = -1;
+        _markerPosted = false;
+    }
+}
+
+//________________________________________________
+void WidgetExplorer::addStyleSample(const char *element, qint64 duration)
+{
+    const QByteArray name(element ? QByteArray(element) : QByteArrayLiteral("Custom"));
+    if (_profiling) {
+        _styleStatistics[name].add(duration);
+    }
+
+    if (_frameWindow) {
+        FrameEntry &entry(_frameElements[name]);
+        ++entry.count;
+        entry.total += duration;
+    }
+}
+
+//________________________________________________
+QMap<QString, qint64> WidgetExplorer::paintEventCounts() const
+{
+    QMap<QString, qint64> counts;
+    for (auto iter = _widgetStatistics.constBegin(); iter != _widgetStatistics.constEnd(); ++iter) {
+        counts.insert(QString::fromLatin1(iter.key()), iter.value().count);
+    }
+
+    return counts;
+}
+
+//________________________________________________
+QMap<QString, qint64> WidgetExplorer::styleCallCounts() const
+{
+    QMap<QString, qint64> counts;
+    for (auto iter = _styleStatistics.constBegin(); iter != _styleStatistics.constEnd(); ++iter) {
+        counts.insert(QString::fromLatin1(iter.key()), iter.value().count);
+    }
+
+    return counts;
+}
+
+//________________________________________________
+void WidgetExplorer::closePaintEvent(qint64 now)
+{
+    if (_paintedClass.isEmpty()) {
+        return;
+    }
+
+    const qint64 duration(now - _paintStart);
+    if (_profiling) {
+        _widgetStatistics[_paintedClass].add(duration);
+    }
+
+    if (_frameWindow) {
+        FrameEntry &entry(_frameWidgets[_paintedClass]);
+        ++entry.count;
+        entry.total += duration;
+    }
+
+    _paintedClass.clear();
+}
+
+//________________________________________________
+void WidgetExplorer::postMarker()
+{
+    if (!_markerPosted) {
+        _markerPosted = true;
+        QCoreApplication::postEvent(this, new QEvent(markerEventType()));
+    }
+}
+
+//________________________________________________
+QEvent::Type WidgetExplorer::markerEventType()
+{
+    static const QEvent::Type type(QEvent::Type(QEvent::registerEventType()));
+    return type;
+}
+
+//________________________________________________
+void WidgetExplorer::addOverdraw(const QPainter *painter, const QRect &rect)
+{
+    // only count what lands on a widget, painting into pixmaps is not overdraw
+    const QPaintDevice *device(painter ? painter->device() : nullptr);
+    if (!(device && device->devType() == QInternal::Widget)) {
+        return;
+    }
+
+    QRectF painted(rect);
+    if (painter->hasClipping()) {
+        painted &= painter->clipBoundingRect();
+    }
+
+    addOverdraw(static_cast<const QWidget *>(device), QRegion(painter->transform().mapRect(painted).toAlignedRect()));
+}
+
+//________________________________________________
+void WidgetExplorer::addOverdraw(const QWidget *widget, const QRegion &region)
+{
+    const QWidget *window(widget->window());
+    if (region.isEmpty() || widget == _overlays.value(window).data()) {
+        return;
+    }
+
+    OverdrawGrid &grid(_overdraw[window]);
+    const QSize size((window->width() + OverdrawTileSize - 1) / OverdrawTileSize, (window->height() + OverdrawTileSize - 1) / OverdrawTileSize);
+    if (grid.size != size) {
+        grid.size = size;
+        grid.layers.fill(0, size.width() * size.height());
+    }
+
+    const QPoint offset(widget->mapTo(window, QPoint(0, 0)));
+    for (const QRect &rect : region) {
+        const QRect mapped(rect.translated(offset));
+        const int left(qMax(0, mapped.left() / OverdrawTileSize));
+        const int right(qMin(size.width() - 1, mapped.right() / OverdrawTileSize));
+        const int top(qMax(0, mapped.top() / OverdrawTileSize));
+        const int bottom(qMin(size.height() - 1, mapped.bottom() / OverdrawTileSize));
+        for (int row = top; row <= bottom; ++row) {
+            for (int column = left; column <= right; ++column) {
+                quint16 &layers(grid.layers[row * size.width() + column]);
+                if (layers < 0xffff) {
+                    ++layers;
+                }
+            }
+        }
+    }
+}
+
+//________________________________________________
+void WidgetExplorer::updateOverlay(QWidget *window)
+{
+    QWidget *overlay(_overlays.value(window).data());
+    if (!overlay) {
+        // register before parenting, since parenting sends the ChildAdded event back here
+        overlay = new OverdrawOverlay(this);
+        _overlays.insert(window, overlay);
+        connect(overlay, &QObject::destroyed, this, [this, window]() {
+            _overlays.remove(window);
+            _overdraw.remove(window);
+        });
+
+        overlay->setParent(window);
+        overlay->setGeometry(window->rect());
+        overlay->raise();
+        overlay->show();
+        return;
+    }
+
+    overlay->setGeometry(window->rect());
+    overlay->raise();
+}
+
+//________________________________________________
+void WidgetExplorer::closeFrame(qint64 now)
+{
+    if (_frameStart < 0) {
+        return;
+    }
+
+    const qint64 duration(now - _frameStart);
+    const QWidget *window(_frameWindow.data());
+    _frameWindow.clear();
+    _frameStart = -1;
+
+    if (duration > qint64(_frameBudget) * 1000000) {
+        qCWarning(ADWAITA_WATCHDOG)
+                << "Adwaita::WidgetExplorer::closeFrame - slow frame in" << window
+                << "took" << duration / 1000 << "us, budget is" << _frameBudget << "ms";
+        dumpFrameEntries("paint events", _frameWidgets);
+        dumpFrameEntries("style calls", _frameElements);
+    }
 }
 
 //________________________________________________
@@ -85,6 +418,74 @@ bool WidgetExplorer::eventFilter(QObject *object, QEvent *event)
 //             }
 //         }
 
+    if (timing()) {
+        const qint64 now(_clock.nsecsElapsed());
+        if (event->type() == QEvent::Paint) {
+            // widgets are painted one after the other, so this ends the previous paint event
+            closePaintEvent(now);
+            if (object->isWidgetType()) {
+                _paintedClass = object->metaObject()->className();
+                _paintStart = now;
+                postMarker();
+            }
+        } else {
+            // anything else ends the paint event and the window repaint
+            closePaintEvent(now);
+            closeFrame(now);
+
+            if (_frameBudget > 0 && event->type() == QEvent::UpdateRequest
+                    && object->isWidgetType() && static_cast<QWidget *>(object)->isWindow()) {
+                _frameWindow = static_cast<QWidget *>(object);
+                _frameStart = now;
+                _frameWidgets.clear();
+                _frameElements.clear();
+                postMarker();
+            }
+
+            if (event->type() == markerEventType() && object == this) {
+                _markerPosted = false;
+                return true;
+            }
+        }
+
+        // the same key press is then forwarded to the focus widget and its parents, only react once
+        if (_profiling && event->type() == QEvent::KeyPress && object->isWindowType()) {
+            QKeyEvent *keyEvent(static_cast<QKeyEvent *>(event));
+            if (keyEvent->key() == Qt::Key_P && keyEvent->modifiers() == (Qt::ControlModifier | Qt::AltModifier | Qt::ShiftModifier)) {
+                dumpProfile();
+            }
+        }
+    }
+
+    if (_drawOverdraw && object->isWidgetType()) {
+        QWidget *widget(static_cast<QWidget *>(object));
+        switch (event->type()) {
+        // only widgets that fill their background paint the whole region; the others paint
+        // through style primitives, which are counted on their own
+        case QEvent::Paint:
+            if (widget->autoFillBackground() || widget->testAttribute(Qt::WA_OpaquePaintEvent)) {
+                addOverdraw(widget, static_cast<QPaintEvent *>(event)->region());
+            }
+            break;
+
+        // keep the overlay above everything else in the window
+        case QEvent::Show:
+        case QEvent::Resize:
+        case QEvent::ChildAdded:
+            if (widget->isWindow()) {
+                updateOverlay(widget);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (!_enabled) {
+        return false;
+    }
+
     switch (event->type()) {
     case QEvent::Paint:
         if (_drawWidgetRects) {
@@ -138,6 +539,87 @@ bool WidgetExplorer::eventFilter(QObject *object, QEvent *event)
     return false;
 }
 
+//________________________________________________
+void WidgetExplorer::dumpProfile() const
+{
+    qCInfo(ADWAITA) << "Adwaita::WidgetExplorer::dumpProfile - times in microseconds, style calls include nested calls";
+    dumpStatistics("paint events", _widgetStatistics);
+    dumpStatistics("style calls", _styleStatistics);
+}
+
+//________________________________________________
+void WidgetExplorer::resetProfile()
+{
+    _widgetStatistics.clear();
+    _styleStatistics.clear();
+}
+
+//________________________________________________
+void WidgetExplorer::dumpStatistics(const char *title, const QHash<QByteArray, Statistics> &statistics) const
+{
+    // most expensive first
+    QList<QByteArray> names(statistics.keys());
+    std::sort(names.begin(), names.end(), [&statistics](const QByteArray &first, const QByteArray &second) {
+        return statistics[first].total > statistics[second].total;
+    });
+
+    qCInfo(ADWAITA).noquote() << title;
+    for (const QByteArray &name : names) {
+        const Statistics &value(statistics[name]);
+        QString line;
+        QTextStream(&line) << "    " << name
+                           << " count: " << value.count
+                           << " total: " << value.total / 1000
+                           << " p50: " << value.percentile(50) / 1000
+                           << " p99: " << value.percentile(99) / 1000;
+        qCInfo(ADWAITA).noquote() << line;
+    }
+}
+
+//________________________________________________
+void WidgetExplorer::dumpFrameEntries(const char *title, const QHash<QByteArray, FrameEntry> &entries) const
+{
+    // most expensive first
+    QList<QByteArray> names(entries.keys());
+    std::sort(names.begin(), names.end(), [&entries](const QByteArray &first, const QByteArray &second) {
+        return entries[first].total > entries[second].total;
+    });
+
+    qCWarning(ADWAITA_WATCHDOG).noquote() << "   " << title;
+    for (const QByteArray &name : names.mid(0, FrameEntryCount)) {
+        const FrameEntry &entry(entries[name]);
+        qCWarning(ADWAITA_WATCHDOG).noquote()
+                << "       " << name << "count:" << entry.count << "total:" << entry.total / 1000 << "us";
+    }
+}
+
+//________________________________________________
+void WidgetExplorer::Statistics::add(qint64 duration)
+{
+    ++count;
+    total += duration;
+
+    if (_samples.size() < ProfileSampleCount) {
+        _samples.append(duration);
+    } else {
+        _samples[_next] = duration;
+        _next = (_next + 1) % ProfileSampleCount;
+    }
+}
+
+//________________________________________________
+qint64 WidgetExplorer::Statistics::percentile(int value) const
+{
+    if (_samples.isEmpty()) {
+        return 0;
+    }
+
+    QVector<qint64> samples(_samples);
+    const int index(qMin(samples.size() - 1, samples.size() * value / 100));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
 //________________________________________________
 QString WidgetExplorer::eventType(const QEvent::Type &type) const
 {
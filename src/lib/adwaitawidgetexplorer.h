@@ -22,15 +22,40 @@
 
 #include "adwaitaqt_export.h"
 
+#include <QElapsedTimer>
 #include <QEvent>
+#include <QHash>
 #include <QMap>
+#include <QMetaEnum>
 #include <QObject>
+#include <QPointer>
 #include <QSet>
+#include <QVector>
 #include <QWidget>
 
+class QPainter;
+
 namespace Adwaita
 {
 //* print widget's and parent's information on mouse click
+/**
+ * also works as a paint profiler: when profiling, the time spent in each widget's paint event
+ * and in each style draw call is aggregated per widget class and per style element.
+ * Profiling is turned on by setting ADWAITA_PROFILE in the environment, in which case a report
+ * is printed on exit, and can be requested with Ctrl+Alt+Shift+P or through dumpProfile().
+ *
+ * It can also watch for slow frames: setting ADWAITA_FRAME_BUDGET to a number of milliseconds
+ * logs, for every window repaint that takes longer, where the time went during that repaint.
+ *
+ * Events are never delivered again nor consumed for timing. A paint event starts when the filter
+ * sees it and ends with the next event of any kind, since widgets are painted one after the other,
+ * parent first. A window repaint starts with its update request and ends with the first event that
+ * is not a paint event. Events sent from inside a paint event therefore end it early.
+ *
+ * Finally it can show overdraw: every style primitive, and every paint event of a widget that
+ * fills its background, adds one layer to the area it covers, and each window gets a translucent
+ * heat map of how many layers its last repaint stacked, from green for two to red for five or more
+ */
 class ADWAITAQT_EXPORT WidgetExplorer : public QObject
 {
     Q_OBJECT
@@ -39,7 +64,10 @@ public:
     explicit WidgetExplorer(QObject *parent);
 
     //* enable
-    bool enabled() const;
+    bool enabled() const
+    {
+        return _enabled;
+    }
 
     //* enable
     void setEnabled(bool);
@@ -50,9 +78,95 @@ public:
         _drawWidgetRects = value;
     }
 
+    //* overdraw heat map
+    bool drawOverdraw() const
+    {
+        return _drawOverdraw;
+    }
+
+    //* overdraw heat map
+    void setDrawOverdraw(bool);
+
+    //* add one layer of overdraw, for a style primitive painting rect
+    void addPaintedRect(const QPainter *painter, const QRect &rect)
+    {
+        if (_drawOverdraw) {
+            addOverdraw(painter, rect);
+        }
+    }
+
+    //* profiling
+    bool profiling() const
+    {
+        return _profiling;
+    }
+
+    //* profiling
+    void setProfiling(bool);
+
+    //* frame budget in milliseconds, zero to disable the slow frame watchdog
+    int frameBudget() const
+    {
+        return _frameBudget;
+    }
+
+    //* frame budget in milliseconds, zero to disable the slow frame watchdog
+    void setFrameBudget(int);
+
+    //* true if paint events and style calls are timed, for profiling or for the watchdog
+    bool timing() const
+    {
+        return _profiling || _frameBudget > 0;
+    }
+
+    //* add one style call duration, in nanoseconds
+    void addStyleSample(const char *element, qint64 duration);
+
+    //* number of timed paint events, per widget class
+    QMap<QString, qint64> paintEventCounts() const;
+
+    //* number of timed style calls, per style element
+    QMap<QString, qint64> styleCallCounts() const;
+
+    //* scoped timing of a style call, does nothing unless profiling
+    template<typename Enum>
+    class Timer
+    {
+    public:
+        Timer(WidgetExplorer *explorer, Enum element)
+            : _explorer(explorer->timing() ? explorer : nullptr)
+            , _element(element)
+        {
+            if (_explorer) {
+                _timer.start();
+            }
+        }
+
+        ~Timer()
+        {
+            if (_explorer) {
+                _explorer->addStyleSample(QMetaEnum::fromType<Enum>().valueToKey(_element), _timer.nsecsElapsed());
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Timer)
+
+        WidgetExplorer *_explorer;
+        Enum _element;
+        QElapsedTimer _timer;
+    };
+
     //* event filter
     virtual bool eventFilter(QObject *object, QEvent *event);
 
+public Q_SLOTS:
+    //* print profile report
+    void dumpProfile() const;
+
+    //* clear profile
+    void resetProfile();
+
 protected:
     //* event type
     QString eventType(const QEvent::Type &type) const;
@@ -61,12 +175,115 @@ protected:
     QString widgetInformation(const QWidget *widget) const;
 
 private:
+    //* aggregated durations, in nanoseconds
+    class Statistics
+    {
+    public:
+        //* add duration
+        void add(qint64 duration);
+
+        //* percentile of the recent samples
+        qint64 percentile(int value) const;
+
+        qint64 count = 0;
+        qint64 total = 0;
+
+    private:
+        //* recent samples, used as a ring buffer once full
+        QVector<qint64> _samples;
+        int _next = 0;
+    };
+
+    //* time spent in one frame
+    struct FrameEntry {
+        int count = 0;
+        qint64 total = 0;
+    };
+
+    //* install or remove the application event filter
+    void updateEventFilter();
+
+    //* end the paint event being timed, if any
+    void closePaintEvent(qint64 now);
+
+    //* end the window repaint being watched, if any, and log it when over budget
+    void closeFrame(qint64 now);
+
+    //* make sure an event reaches the filter once the current one is delivered
+    void postMarker();
+
+    //* marker event type
+    static QEvent::Type markerEventType();
+
+    //* print one section of a slow frame breakdown
+    void dumpFrameEntries(const char *title, const QHash<QByteArray, FrameEntry> &entries) const;
+
+    //* add one layer of overdraw over rect, in painter coordinates
+    void addOverdraw(const QPainter *painter, const QRect &rect);
+
+    //* add one layer of overdraw over region, in widget coordinates
+    void addOverdraw(const QWidget *widget, const QRegion &region);
+
+    //* create or raise the overlay of widget's window
+    void updateOverlay(QWidget *window);
+
+    friend class OverdrawOverlay;
+
+    //* print one section of the profile report
+    void dumpStatistics(const char *title, const QHash<QByteArray, Statistics> &statistics) const;
+
     //* enable state
     bool _enabled;
 
     //* widget rects
     bool _drawWidgetRects;
 
+    //* overdraw heat map
+    bool _drawOverdraw;
+
+    //* layers painted per tile of each window, since its overlay was last painted
+    struct OverdrawGrid {
+        QSize size;
+        QVector<quint16> layers;
+    };
+
+    QHash<const QWidget *, OverdrawGrid> _overdraw;
+
+    //* overlays, per window
+    QHash<const QWidget *, QPointer<QWidget>> _overlays;
+
+    //* profiling state
+    bool _profiling;
+
+    //* clock all timings are read from, in nanoseconds
+    QElapsedTimer _clock;
+
+    //* class of the widget whose paint event is being timed, and when it started
+    QByteArray _paintedClass;
+    qint64 _paintStart;
+
+    //* true if a marker event is on its way
+    bool _markerPosted;
+
+    //* paint time per widget class
+    QHash<QByteArray, Statistics> _widgetStatistics;
+
+    //* time per style element
+    QHash<QByteArray, Statistics> _styleStatistics;
+
+    //* frame budget, in milliseconds
+    int _frameBudget;
+
+    //* window being repainted, and when it started
+    QPointer<QWidget> _frameWindow;
+    qint64 _frameStart;
+
+    //* paint time per widget class, during the current frame
+    QHash<QByteArray, FrameEntry> _frameWidgets;
+
+    //* time per style element, during the current frame
+    QHash<QByteArray, FrameEntry> _frameElements;
+
     //* map event types to string
     QMap<QEvent::Type, QString> _eventTypes;
 };
@@ -18,3 +18,17 @@
  *************************************************************************/
 
 #include "adwaitaanimation.h"
+#include "adwaitatracer.h"
+
+namespace Adwaita
+{
+
+//______________________________________________________________
+void Animation::updateCurrentTime(int currentTime)
+{
+    const QByteArray name(Tracer::enabled() ? propertyName() : QByteArray());
+    const Tracer::Event trace("animation", name.constData(), targetObject());
+    QPropertyAnimation::updateCurrentTime(currentTime);
+}
+
+} // namespace Adwaita
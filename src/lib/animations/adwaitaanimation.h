@@ -60,6 +60,10 @@ public:
 
         start();
     }
+
+protected:
+    //* animation tick
+    virtual void updateCurrentTime(int currentTime);
 };
 
 } // namespace Adwaita
@@ -18,6 +18,7 @@
  *************************************************************************/
 
 #include "adwaitaanimations.h"
+#include "adwaitaruntimeconfig.h"
 
 #include <QAbstractItemView>
 #include <QComboBox>
@@ -58,13 +59,13 @@ Animations::Animations(QObject *parent)
 }
 
 //____________________________________________________________
-void Animations::setupEngines()
+void Animations::setupEngines(const RuntimeConfig &config)
 {
     // animation steps
     AnimationData::setSteps(Adwaita::Config::AnimationSteps);
 
-    bool animationsEnabled(Adwaita::Config::AnimationsEnabled);
-    int animationsDuration(Adwaita::Config::AnimationsDuration);
+    bool animationsEnabled(config.animationsEnabled());
+    int animationsDuration(config.animationsDuration());
 
     _widgetEnabilityEngine->setEnabled(animationsEnabled);
     _comboBoxEngine->setEnabled(animationsEnabled);
@@ -86,11 +87,11 @@ void Animations::setupEngines()
     }
 
     // stacked widget transition has an extra flag for animations
-    _stackedWidgetEngine->setEnabled(animationsEnabled && Adwaita::Config::StackedWidgetTransitionsEnabled);
+    _stackedWidgetEngine->setEnabled(animationsEnabled && config.stackedWidgetTransitionsEnabled());
 
     // busy indicator
-    _busyIndicatorEngine->setEnabled(Adwaita::Config::ProgressBarAnimated);
-    _busyIndicatorEngine->setDuration(Adwaita::Config::ProgressBarBusyStepDuration);
+    _busyIndicatorEngine->setEnabled(config.progressBarAnimated());
+    _busyIndicatorEngine->setDuration(config.progressBarBusyStepDuration());
 }
 
 //____________________________________________________________
@@ -190,7 +191,8 @@ void Animations::unregisterWidget(QWidget *widget) const
     _widgetEnabilityEngine->unregisterWidget(widget);
     _spinBoxEngine->unregisterWidget(widget);
     _comboBoxEngine->unregisterWidget(widget);
-    _busyIndicatorEngine->registerWidget(widget);
+    _toolButtonEngine->unregisterWidget(widget);
+    _busyIndicatorEngine->unregisterWidget(widget);
 
     // the following allows some optimization of widget unregistration
     // it assumes that a widget can be registered atmost in one of the
@@ -202,6 +204,50 @@ void Animations::unregisterWidget(QWidget *widget) const
     }
 }
 
+//_______________________________________________________________
+QMap<QString, int> Animations::dataCounts() const
+{
+    QMap<QString, int> counts;
+    const QMap<QString, const BaseEngine *> engines(namedEngines());
+    for (auto iter = engines.constBegin(); iter != engines.constEnd(); ++iter) {
+        counts.insert(iter.key(), iter.value()->dataCount());
+    }
+
+    return counts;
+}
+
+//_______________________________________________________________
+QMap<QString, qint64> Animations::pixmapBytes() const
+{
+    QMap<QString, qint64> bytes;
+    const QMap<QString, const BaseEngine *> engines(namedEngines());
+    for (auto iter = engines.constBegin(); iter != engines.constEnd(); ++iter) {
+        bytes.insert(iter.key(), iter.value()->pixmapBytes());
+    }
+
+    return bytes;
+}
+
+//_______________________________________________________________
+QMap<QString, const BaseEngine *> Animations::namedEngines() const
+{
+    QMap<QString, const BaseEngine *> engines;
+    engines.insert(QStringLiteral("widgetEnability"), _widgetEnabilityEngine);
+    engines.insert(QStringLiteral("busyIndicator"), _busyIndicatorEngine);
+    engines.insert(QStringLiteral("comboBox"), _comboBoxEngine);
+    engines.insert(QStringLiteral("toolButton"), _toolButtonEngine);
+    engines.insert(QStringLiteral("spinBox"), _spinBoxEngine);
+    engines.insert(QStringLiteral("toolBox"), _toolBoxEngine);
+    engines.insert(QStringLiteral("headerView"), _headerViewEngine);
+    engines.insert(QStringLiteral("widgetState"), _widgetStateEngine);
+    engines.insert(QStringLiteral("inputWidget"), _inputWidgetEngine);
+    engines.insert(QStringLiteral("scrollBar"), _scrollBarEngine);
+    engines.insert(QStringLiteral("stackedWidget"), _stackedWidgetEngine);
+    engines.insert(QStringLiteral("tabBar"), _tabBarEngine);
+    engines.insert(QStringLiteral("dial"), _dialEngine);
+    return engines;
+}
+
 //_______________________________________________________________
 void Animations::unregisterEngine(QObject *object)
 {
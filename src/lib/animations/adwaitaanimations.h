@@ -32,10 +32,13 @@
 #include "adwaitaqt_export.h"
 
 #include <QList>
+#include <QMap>
 #include <QObject>
 
 namespace Adwaita
 {
+class RuntimeConfig;
+
 //* stores engines
 class ADWAITAQT_EXPORT Animations : public QObject
 {
@@ -129,7 +132,13 @@ public:
     }
 
     //* setup engines
-    void setupEngines();
+    void setupEngines(const RuntimeConfig &);
+
+    //* number of animation data objects per engine, for diagnostics
+    QMap<QString, int> dataCounts() const;
+
+    //* memory held by animation pixmaps per engine, in bytes, for diagnostics
+    QMap<QString, qint64> pixmapBytes() const;
 
 protected Q_SLOTS:
 
@@ -140,6 +149,9 @@ private:
     //* register new engine
     void registerEngine(BaseEngine *engine);
 
+    //* all engines, by name
+    QMap<QString, const BaseEngine *> namedEngines() const;
+
     //* busy indicator
     BusyIndicatorEngine *_busyIndicatorEngine;
 
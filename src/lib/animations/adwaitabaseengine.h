@@ -85,6 +85,18 @@ public:
         return WidgetList();
     }
 
+    //* number of animation data objects held by the engine
+    virtual int dataCount() const
+    {
+        return 0;
+    }
+
+    //* memory held by pixmaps of the animation data objects, in bytes
+    virtual qint64 pixmapBytes() const
+    {
+        return 0;
+    }
+
 private:
     //* engine enability
     bool _enabled;
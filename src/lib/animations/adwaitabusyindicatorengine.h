@@ -76,6 +76,12 @@ public:
 
     //@}
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _data.size();
+    }
+
 public Q_SLOTS:
 
     //* remove widget from map
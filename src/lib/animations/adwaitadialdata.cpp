@@ -56,6 +56,22 @@ bool DialData::eventFilter(QObject *object, QEvent *event)
     return WidgetStateData::eventFilter(object, event);
 }
 
+//______________________________________________
+void DialData::setDirty() const
+{
+    QWidget *widget(target().data());
+    if (!widget) {
+        return;
+    }
+
+    // leave room for the handle outline and antialiasing
+    if (_handleRect.isValid()) {
+        widget->update(_handleRect.adjusted(-2, -2, 2, 2));
+    } else {
+        widget->update();
+    }
+}
+
 //______________________________________________
 void DialData::hoverMoveEvent(QObject *object, QEvent *event)
 {
@@ -54,6 +54,9 @@ public:
     }
 
 protected:
+    //* only the handle changes with hover, update it rather than the whole dial
+    virtual void setDirty() const;
+
     //* hoverMoveEvent
     virtual void hoverMoveEvent(QObject *, QEvent *);
 
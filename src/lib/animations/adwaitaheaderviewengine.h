@@ -81,6 +81,12 @@ public:
         _data.setDuration(value);
     }
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _data.size();
+    }
+
 public Q_SLOTS:
 
     //* remove widget from map
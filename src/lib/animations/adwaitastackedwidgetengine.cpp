@@ -26,6 +26,8 @@
 
 #include "adwaitastackedwidgetengine.h"
 
+#include <QSet>
+
 namespace Adwaita
 {
 
@@ -47,4 +49,27 @@ bool StackedWidgetEngine::registerWidget(QStackedWidget *widget)
     return true;
 }
 
+//____________________________________________________________
+qint64 StackedWidgetEngine::pixmapBytes() const
+{
+    // current and end pixmaps usually share their data, count it once
+    QSet<qint64> pixmaps;
+    qint64 bytes(0);
+    for (const DataMap<StackedWidgetData>::Value &value : _data) {
+        if (!(value && value.data()->transition())) {
+            continue;
+        }
+
+        const TransitionWidget *transition(value.data()->transition().data());
+        for (const QPixmap *pixmap : { &transition->startPixmap(), &transition->endPixmap(), &transition->currentPixmap() }) {
+            if (!pixmap->isNull() && !pixmaps.contains(pixmap->cacheKey())) {
+                pixmaps.insert(pixmap->cacheKey());
+                bytes += qint64(pixmap->width()) * pixmap->height() * pixmap->depth() / 8;
+            }
+        }
+    }
+
+    return bytes;
+}
+
 } // namespace Adwaita
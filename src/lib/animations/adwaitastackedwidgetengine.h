@@ -67,6 +67,15 @@ public:
         _data.setDuration(value);
     }
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _data.size();
+    }
+
+    //* memory held by transition pixmaps, in bytes
+    virtual qint64 pixmapBytes() const;
+
 public Q_SLOTS:
 
     //! remove widget from map
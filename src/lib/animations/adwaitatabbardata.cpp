@@ -45,12 +45,50 @@
 
 #include "adwaitatabbardata.h"
 
+#include <QHash>
 #include <QHoverEvent>
 #include <QTabBar>
+#include <QVector>
 
 namespace Adwaita
 {
 
+//* visible tab rects of a tab bar, in layout order
+class TabRects
+{
+public:
+    //* true if cached tab rects still match the tab bar layout
+    bool isValid(const QTabBar *) const;
+
+    //* rebuild cached tab rects
+    void update(const QTabBar *);
+
+    //* binary search in cached tab rects
+    int find(const QPoint &) const;
+
+private:
+    //* cached tab rect
+    class TabRect
+    {
+    public:
+        QRect _rect;
+        int _index;
+    };
+
+    //* visible tab rects
+    QVector<TabRect> _rects;
+
+    //* number of tabs when rects were cached
+    int _count = 0;
+
+    //* true if cached tabs are laid out vertically
+    bool _vertical = false;
+};
+
+//* cached tab rects, per tab bar data
+using TabRectsHash = QHash<const TabBarData *, TabRects>;
+Q_GLOBAL_STATIC(TabRectsHash, tabRectsGlobal)
+
 //______________________________________________
 TabBarData::TabBarData(QObject *parent, QWidget *target, int duration)
     : AnimationData(parent, target)
@@ -62,6 +100,14 @@ TabBarData::TabBarData(QObject *parent, QWidget *target, int duration)
     _previous._animation = new Animation(duration, this);
     setupAnimation(previousIndexAnimation(), "previousOpacity");
     previousIndexAnimation().data()->setDirection(Animation::Backward);
+
+    // drop cached tab rects together with the data
+    const TabBarData *key(this);
+    connect(this, &QObject::destroyed, [key]() {
+        if (tabRectsGlobal.exists()) {
+            tabRectsGlobal()->remove(key);
+        }
+    });
 }
 
 //______________________________________________
@@ -76,7 +122,7 @@ Animation::Pointer TabBarData::animation(const QPoint &position) const
         return Animation::Pointer();
     }
 
-    int index(local->tabAt(position));
+    int index(tabAt(local, position));
     if (index < 0) {
         return Animation::Pointer();
     } else if (index == currentIndex()) {
@@ -100,7 +146,7 @@ bool TabBarData::updateState(const QPoint &position, bool hovered)
         return false;
     }
 
-    int index(local->tabAt(position));
+    int index(tabAt(local, position));
     if (index < 0) {
         return false;
     }
@@ -141,7 +187,7 @@ qreal TabBarData::opacity(const QPoint &position) const
         return OpacityInvalid;
     }
 
-    int index(local->tabAt(position));
+    int index(tabAt(local, position));
     if (index < 0) {
         return OpacityInvalid;
     } else if (index == currentIndex()) {
@@ -153,4 +199,117 @@ qreal TabBarData::opacity(const QPoint &position) const
     }
 }
 
+//______________________________________________
+int TabBarData::tabAt(const QTabBar *tabBar, const QPoint &position) const
+{
+    // the current tab may overlap its neighbours, check it first like QTabBar does
+    const int currentTab(tabBar->currentIndex());
+    if (currentTab >= 0 && tabBar->tabRect(currentTab).contains(position)) {
+        return currentTab;
+    }
+
+    TabRects &tabRects((*tabRectsGlobal())[this]);
+    if (!tabRects.isValid(tabBar)) {
+        tabRects.update(tabBar);
+    }
+
+    // tabs are contiguous, so a miss is reliable as long as the outer tabs did not move.
+    // A hit still needs checking, since tabs in between may have been resized or moved
+    int index(tabRects.find(position));
+    if (index < 0 || tabBar->tabRect(index).contains(position)) {
+        return index;
+    }
+
+    tabRects.update(tabBar);
+    return tabRects.find(position);
+}
+
+//______________________________________________
+bool TabRects::isValid(const QTabBar *tabBar) const
+{
+    if (tabBar->count() != _count) {
+        return false;
+    }
+
+    if (_rects.isEmpty()) {
+        return _count == 0;
+    }
+
+    const TabRect &first(_rects.first());
+    const TabRect &last(_rects.last());
+    return tabBar->tabRect(first._index) == first._rect && tabBar->tabRect(last._index) == last._rect;
+}
+
+//______________________________________________
+void TabRects::update(const QTabBar *tabBar)
+{
+    _count = tabBar->count();
+    _rects.clear();
+    _rects.reserve(_count);
+
+    switch (tabBar->shape()) {
+    case QTabBar::RoundedWest:
+    case QTabBar::RoundedEast:
+    case QTabBar::TriangularWest:
+    case QTabBar::TriangularEast:
+        _vertical = true;
+        break;
+    default:
+        _vertical = false;
+        break;
+    }
+
+    // hidden tabs have empty rects and are skipped
+    for (int index = 0; index < _count; ++index) {
+        const QRect rect(tabBar->tabRect(index));
+        if (rect.isValid()) {
+            TabRect tabRect;
+            tabRect._rect = rect;
+            tabRect._index = index;
+            _rects.append(tabRect);
+        }
+    }
+}
+
+//______________________________________________
+int TabRects::find(const QPoint &position) const
+{
+    if (_rects.isEmpty()) {
+        return -1;
+    }
+
+    // right to left layouts store tabs in decreasing order
+    const int value(_vertical ? position.y() : position.x());
+    const bool reversed(_vertical ?
+                        _rects.first()._rect.top() > _rects.last()._rect.top() :
+                        _rects.first()._rect.left() > _rects.last()._rect.left());
+
+    int low(0);
+    int high(_rects.size() - 1);
+    while (low <= high) {
+        const int middle((low + high) / 2);
+        const QRect &rect(_rects.at(middle)._rect);
+        const int begin(_vertical ? rect.top() : rect.left());
+        const int end(_vertical ? rect.bottom() : rect.right());
+
+        if (value < begin) {
+            if (reversed) {
+                low = middle + 1;
+            } else {
+                high = middle - 1;
+            }
+        } else if (value > end) {
+            if (reversed) {
+                high = middle - 1;
+            } else {
+                low = middle + 1;
+            }
+        } else {
+            return rect.contains(position) ? _rects.at(middle)._index : -1;
+        }
+    }
+
+    return -1;
+}
+
 } // namespace Adwaita
@@ -140,6 +140,15 @@ public:
     //* return opacity associated to action at given position, if any
     virtual qreal opacity(const QPoint &position) const;
 
+protected:
+    //* index of the tab at given position, or -1
+    /**
+     * same as QTabBar::tabAt, but uses a binary search over cached tab rects
+     * rather than querying every tab, which matters for tab bars with many tabs.
+     * The cache lives in the translation unit to keep the class layout unchanged
+     */
+    int tabAt(const QTabBar *, const QPoint &) const;
+
 private:
     //* container for needed animation data
     class Data
@@ -75,6 +75,12 @@ public:
         _focusData.setDuration(value);
     }
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _hoverData.size() + _focusData.size();
+    }
+
 public Q_SLOTS:
 
     //* remove widget from map
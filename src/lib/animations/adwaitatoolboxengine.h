@@ -73,6 +73,12 @@ public:
         return isAnimated(object) ? data(object).data()->opacity() : AnimationData::OpacityInvalid;
     }
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _data.size();
+    }
+
 public Q_SLOTS:
 
     //* remove widget from map
@@ -148,6 +148,12 @@ public:
         _pressedData.setDuration(value / 2);
     }
 
+    //* number of animation data objects
+    virtual int dataCount() const
+    {
+        return _hoverData.size() + _focusData.size() + _enableData.size() + _pressedData.size();
+    }
+
 public Q_SLOTS:
     //* remove widget from map
     virtual bool unregisterWidget(QObject *object)
@@ -0,0 +1,168 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitadbuscounters.h"
+#include "adwaitastyle.h"
+
+// Adwaita lib
+#include "adwaitawidgetexplorer.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+
+namespace Adwaita
+{
+
+//______________________________________________________________
+DBusCounters::DBusCounters(Style *parent)
+    : QObject(parent)
+    , _service(QStringLiteral("org.fedoraproject.AdwaitaQt.pid%1").arg(QCoreApplication::applicationPid()))
+    , _style(parent)
+    , _registered(false)
+{
+    QDBusConnection connection(QDBusConnection::sessionBus());
+    if (!connection.isConnected()) {
+        return;
+    }
+
+    _registered = connection.registerObject(QStringLiteral("/Counters"), this, QDBusConnection::ExportAllSlots)
+                  && connection.registerService(_service);
+}
+
+//______________________________________________________________
+DBusCounters::~DBusCounters()
+{
+    if (_registered) {
+        QDBusConnection connection(QDBusConnection::sessionBus());
+        connection.unregisterService(_service);
+        connection.unregisterObject(QStringLiteral("/Counters"));
+    }
+}
+
+//______________________________________________________________
+QVariantMap DBusCounters::drawCalls() const
+{
+    QVariantMap out;
+    const QMap<QString, qint64> counts(_style->widgetExplorer()->styleCallCounts());
+    for (auto iter = counts.constBegin(); iter != counts.constEnd(); ++iter) {
+        out.insert(iter.key(), qlonglong(iter.value()));
+    }
+
+    return out;
+}
+
+//______________________________________________________________
+QVariantMap DBusCounters::paintEvents() const
+{
+    QVariantMap out;
+    const QMap<QString, qint64> counts(_style->widgetExplorer()->paintEventCounts());
+    for (auto iter = counts.constBegin(); iter != counts.constEnd(); ++iter) {
+        out.insert(iter.key(), qlonglong(iter.value()));
+    }
+
+    return out;
+}
+
+//______________________________________________________________
+QVariantMap DBusCounters::caches() const
+{
+    QVariantMap out;
+    const QMap<QString, Renderer::CacheStatistics> statistics(_style->cacheStatistics());
+    for (auto iter = statistics.constBegin(); iter != statistics.constEnd(); ++iter) {
+        QVariantMap cache;
+        cache.insert(QStringLiteral("hits"), qulonglong(iter.value().hits));
+        cache.insert(QStringLiteral("misses"), qulonglong(iter.value().misses));
+        cache.insert(QStringLiteral("count"), iter.value().count);
+        cache.insert(QStringLiteral("maxCount"), iter.value().maxCount);
+        cache.insert(QStringLiteral("bytes"), qlonglong(iter.value().bytes));
+        out.insert(iter.key(), cache);
+    }
+
+    return out;
+}
+
+//______________________________________________________________
+QVariantMap DBusCounters::animations() const
+{
+    QVariantMap out;
+    const QMap<QString, int> counts(_style->animationDataCounts());
+    for (auto iter = counts.constBegin(); iter != counts.constEnd(); ++iter) {
+        out.insert(iter.key(), iter.value());
+    }
+
+    return out;
+}
+
+//______________________________________________________________
+qlonglong DBusCounters::pixmapBytes() const
+{
+    // paths and sub control rects hold no pixmaps
+    static const char *const pixmapCaches[] = { "glyphs", "indicatorSprites", "branchGlyphs", "tabShapes", "sliderTicks" };
+
+    qlonglong bytes(0);
+    const QMap<QString, Renderer::CacheStatistics> statistics(_style->cacheStatistics());
+    for (const char *name : pixmapCaches) {
+        bytes += statistics.value(QLatin1String(name)).bytes;
+    }
+
+    return bytes;
+}
+
+//______________________________________________________________
+QVariantMap DBusCounters::memory() const
+{
+    QVariantMap out;
+    const QMap<QString, Style::MemoryUsage> usage(_style->memoryUsage());
+    for (auto iter = usage.constBegin(); iter != usage.constEnd(); ++iter) {
+        QVariantMap subsystem;
+        subsystem.insert(QStringLiteral("objects"), iter.value().objects);
+        subsystem.insert(QStringLiteral("bytes"), qlonglong(iter.value().bytes));
+        out.insert(iter.key(), subsystem);
+    }
+
+    return out;
+}
+
+//______________________________________________________________
+qulonglong DBusCounters::rejectedDrawCalls() const
+{
+    return _style->rejectedDrawCalls();
+}
+
+//______________________________________________________________
+bool DBusCounters::profiling() const
+{
+    return _style->widgetExplorer()->profiling();
+}
+
+//______________________________________________________________
+void DBusCounters::setProfiling(bool value)
+{
+    _style->widgetExplorer()->setProfiling(value);
+}
+
+//______________________________________________________________
+void DBusCounters::reset()
+{
+    _style->resetStatistics();
+}
+
+} // namespace Adwaita
@@ -0,0 +1,99 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_DBUS_COUNTERS_H
+#define ADWAITA_DBUS_COUNTERS_H
+
+#include <QObject>
+#include <QVariantMap>
+
+namespace Adwaita
+{
+class Style;
+
+//* style counters, exported on the session bus
+/**
+ * created when ADWAITA_DBUS_COUNTERS is set in the environment. The object is registered
+ * as /Counters under the service name org.fedoraproject.AdwaitaQt.pid<pid>, one per application
+ */
+class DBusCounters : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.fedoraproject.AdwaitaQt.Counters")
+
+public:
+    //* constructor
+    explicit DBusCounters(Style *parent);
+
+    //* destructor
+    virtual ~DBusCounters();
+
+    //* true if registered on the session bus
+    bool isRegistered() const
+    {
+        return _registered;
+    }
+
+public Q_SLOTS:
+    //* timed style calls per element. Only counted while profiling
+    QVariantMap drawCalls() const;
+
+    //* timed paint events per widget class. Only counted while profiling
+    QVariantMap paintEvents() const;
+
+    //* hits, misses, size and bytes of each cache
+    QVariantMap caches() const;
+
+    //* animation data objects per engine
+    QVariantMap animations() const;
+
+    //* memory held by cached pixmaps, in bytes
+    qlonglong pixmapBytes() const;
+
+    //* objects and bytes held by each style subsystem
+    QVariantMap memory() const;
+
+    //* draw calls skipped because they fall outside of the painter clip region
+    qulonglong rejectedDrawCalls() const;
+
+    //* profiling
+    bool profiling() const;
+
+    //* profiling
+    void setProfiling(bool value);
+
+    //* reset all counters
+    void reset();
+
+private:
+    //* service name
+    QString _service;
+
+    //* style
+    Style *_style;
+
+    //* registration state
+    bool _registered;
+};
+
+} // namespace Adwaita
+
+#endif // ADWAITA_DBUS_COUNTERS_H
@@ -21,19 +21,26 @@
 
 // Adwaita style
 #include "adwaitastyle.h"
+#include "adwaitadbuscounters.h"
 #include "adwaitahelper.h"
 
 // Adwaita lib
 #include "animations/adwaitaanimations.h"
 #include "adwaita.h"
 #include "adwaitacolors.h"
+#include "adwaitacolorscheme.h"
 #include "adwaitamnemonics.h"
+#include "adwaitapainterstateguard.h"
 #include "adwaitasplitterproxy.h"
 #include "adwaitarenderer.h"
+#include "adwaitarenderer_p.h"
+#include "adwaitaruntimeconfig.h"
+#include "adwaitatracer.h"
 #include "adwaitawidgetexplorer.h"
 #include "adwaitawindowmanager.h"
 
 #include <QApplication>
+#include <QCache>
 #include <QCheckBox>
 #include <QComboBox>
 #include <QDBusConnection>
@@ -45,10 +52,13 @@
 #include <QGroupBox>
 #include <QItemDelegate>
 #include <QLineEdit>
+#include <QLoggingCategory>
 #include <QMainWindow>
 #include <QMdiSubWindow>
 #include <QMenu>
+#include <QPaintEngine>
 #include <QPainter>
+#include <QProgressBar>
 #include <QProxyStyle>
 #include <QPushButton>
 #include <QRadioButton>
@@ -60,11 +70,16 @@
 #include <QToolBox>
 #include <QToolButton>
 #include <QWidgetAction>
+#include <QtMath>
+
+#include <algorithm>
 
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
 #endif
 
+Q_LOGGING_CATEGORY(ADWAITA_STYLE, "adwaita.style")
+
 namespace AdwaitaPrivate
 {
 // needed to keep track of tabbars when being dragged
@@ -153,6 +168,815 @@ private:
     int _itemMargin;
 };
 
+//* pixel metric or style hint value that does not depend on option nor widget
+struct MetricEntry {
+    int key;
+    int value;
+};
+
+//* option independent pixel metrics, served by Style::pixelMetric without going through the switch
+constexpr MetricEntry staticPixelMetrics[] = {
+    // frame width
+    { QStyle::PM_SpinBoxFrameWidth, Adwaita::Metrics::SpinBox_FrameWidth },
+    { QStyle::PM_ToolBarFrameWidth, Adwaita::Metrics::ToolBar_FrameWidth },
+    { QStyle::PM_ToolTipLabelFrameWidth, Adwaita::Metrics::ToolTip_FrameWidth },
+
+    // layout
+    { QStyle::PM_LayoutHorizontalSpacing, Adwaita::Metrics::Layout_DefaultSpacing },
+    { QStyle::PM_LayoutVerticalSpacing, Adwaita::Metrics::Layout_DefaultSpacing },
+
+    // buttons
+    { QStyle::PM_ButtonDefaultIndicator, 0 },
+    { QStyle::PM_ButtonShiftHorizontal, 0 },
+    { QStyle::PM_ButtonShiftVertical, 0 },
+
+    // menubars
+    { QStyle::PM_MenuBarPanelWidth, 0 },
+    { QStyle::PM_MenuBarHMargin, 0 },
+    { QStyle::PM_MenuBarVMargin, 0 },
+    { QStyle::PM_MenuBarItemSpacing, 0 },
+    { QStyle::PM_MenuDesktopFrameWidth, 0 },
+
+    // menu buttons
+    { QStyle::PM_MenuButtonIndicator, Adwaita::Metrics::MenuButton_IndicatorWidth },
+    { QStyle::PM_MenuVMargin, 2 },
+
+    // toolbars
+    { QStyle::PM_ToolBarHandleExtent, Adwaita::Metrics::ToolBar_HandleExtent },
+    { QStyle::PM_ToolBarSeparatorExtent, Adwaita::Metrics::ToolBar_SeparatorWidth },
+    { QStyle::PM_ToolBarItemMargin, 0 },
+    { QStyle::PM_ToolBarItemSpacing, Adwaita::Metrics::ToolBar_ItemSpacing },
+
+    // tabbars
+    { QStyle::PM_TabBarTabShiftVertical, 0 },
+    { QStyle::PM_TabBarTabShiftHorizontal, 0 },
+    { QStyle::PM_TabBarTabOverlap, Adwaita::Metrics::TabBar_TabOverlap },
+    { QStyle::PM_TabBarBaseOverlap, Adwaita::Metrics::TabBar_BaseOverlap },
+    { QStyle::PM_TabBarTabHSpace, 2 * Adwaita::Metrics::TabBar_TabMarginWidth },
+    { QStyle::PM_TabBarTabVSpace, 2 * Adwaita::Metrics::TabBar_TabMarginHeight },
+
+    // scrollbars
+    { QStyle::PM_ScrollBarExtent, Adwaita::Metrics::ScrollBar_Extend },
+    { QStyle::PM_ScrollBarSliderMin, Adwaita::Metrics::ScrollBar_MinSliderHeight },
+
+    // sliders
+    { QStyle::PM_SliderThickness, Adwaita::Metrics::Slider_ControlThickness },
+    { QStyle::PM_SliderControlThickness, Adwaita::Metrics::Slider_ControlThickness },
+    { QStyle::PM_SliderLength, Adwaita::Metrics::Slider_ControlThickness },
+
+    // checkboxes and radio buttons
+    { QStyle::PM_IndicatorWidth, Adwaita::Metrics::CheckBox_Size },
+    { QStyle::PM_IndicatorHeight, Adwaita::Metrics::CheckBox_Size },
+    { QStyle::PM_ExclusiveIndicatorWidth, Adwaita::Metrics::CheckBox_Size },
+    { QStyle::PM_ExclusiveIndicatorHeight, Adwaita::Metrics::CheckBox_Size },
+
+    // list headers
+    { QStyle::PM_HeaderMarkSize, Adwaita::Metrics::Header_ArrowSize },
+    { QStyle::PM_HeaderMargin, Adwaita::Metrics::Header_MarginWidth },
+
+    // dock widget
+    // return 0 here, since frame is handled directly in polish
+    { QStyle::PM_DockWidgetFrameWidth, 0 },
+    { QStyle::PM_DockWidgetTitleMargin, Adwaita::Metrics::Frame_FrameWidth },
+    { QStyle::PM_DockWidgetTitleBarButtonMargin, Adwaita::Metrics::ToolButton_MarginWidth },
+
+    // splitters
+    { QStyle::PM_SplitterWidth, Adwaita::Metrics::Splitter_SplitterWidth },
+    { QStyle::PM_DockWidgetSeparatorExtent, Adwaita::Metrics::Splitter_SplitterWidth }
+};
+
+//* option independent style hints, served by Style::styleHint without going through the switch
+constexpr MetricEntry staticStyleHints[] = {
+    { QStyle::SH_ComboBox_ListMouseTracking, true },
+    { QStyle::SH_MenuBar_MouseTracking, true },
+    { QStyle::SH_Menu_MouseTracking, true },
+    { QStyle::SH_Menu_SubMenuPopupDelay, 150 },
+    { QStyle::SH_Menu_SloppySubMenus, true },
+    { QStyle::SH_Menu_SupportsSections, true },
+    { QStyle::SH_DialogButtonBox_ButtonsHaveIcons, false },
+    { QStyle::SH_GroupBox_TextLabelVerticalAlignment, Qt::AlignVCenter },
+    { QStyle::SH_TabBar_Alignment, Adwaita::Config::TabBarDrawCenteredTabs ? int(Qt::AlignCenter) : int(Qt::AlignLeft) },
+    { QStyle::SH_ToolBox_SelectedPageTitleBold, false },
+    { QStyle::SH_ScrollBar_MiddleClickAbsolutePosition, true },
+    { QStyle::SH_ScrollView_FrameOnlyAroundContents, false },
+    { QStyle::SH_FormLayoutFormAlignment, int(Qt::AlignLeft) | int(Qt::AlignTop) },
+    { QStyle::SH_FormLayoutLabelAlignment, Qt::AlignRight },
+    { QStyle::SH_FormLayoutFieldGrowthPolicy, QFormLayout::ExpandingFieldsGrow },
+    { QStyle::SH_FormLayoutWrapPolicy, QFormLayout::DontWrapRows },
+    { QStyle::SH_MessageBox_TextInteractionFlags, int(Qt::TextSelectableByMouse) | int(Qt::LinksAccessibleByMouse) },
+    { QStyle::SH_ProgressDialog_CenterCancelButton, false },
+    { QStyle::SH_MessageBox_CenterButtons, false },
+    { QStyle::SH_RequestSoftwareInputPanel, QStyle::RSIP_OnMouseClick },
+    { QStyle::SH_TitleBar_NoBorder, true },
+    { QStyle::SH_DockWidget_ButtonsHaveFrame, false },
+    { QStyle::SH_ToolTipLabel_Opacity, 204 } // Should have 30% transparency
+};
+
+//* compile time index list, std::index_sequence is not available in C++11
+template<int... I>
+struct MetricIndices {
+};
+
+template<int N, int... I>
+struct MakeMetricIndices : MakeMetricIndices<N - 1, N - 1, I...> {
+};
+
+template<int... I>
+struct MakeMetricIndices<0, I...> {
+    using type = MetricIndices<I...>;
+};
+
+//* one slot of a metric table
+struct MetricSlot {
+    int value;
+    bool valid;
+};
+
+//* position of key in entries, starting from index, or -1
+template<std::size_t N>
+constexpr int findMetricEntry(const MetricEntry (&entries)[N], int key, std::size_t index = 0)
+{
+    return index == N ? -1 : entries[index].key == key ? int(index) : findMetricEntry(entries, key, index + 1);
+}
+
+//* table slot for key
+template<std::size_t N>
+constexpr MetricSlot metricSlot(const MetricEntry (&entries)[N], int key)
+{
+    return findMetricEntry(entries, key) < 0 ? MetricSlot { 0, false } : MetricSlot { entries[findMetricEntry(entries, key)].value, true };
+}
+
+//* true if every key of entries fits in a table of size slots
+template<std::size_t N>
+constexpr bool metricKeysFit(const MetricEntry (&entries)[N], int size, std::size_t index = 0)
+{
+    return index == N || (entries[index].key >= 0 && entries[index].key < size && metricKeysFit(entries, size, index + 1));
+}
+
+//* dense table, indexed by pixel metric or style hint, generated at compile time from the entries above
+class MetricTable
+{
+public:
+    //* enum values above this size are left to the switch
+    enum { Size = 256 };
+
+    //* constructor
+    template<std::size_t N, int... I>
+    constexpr MetricTable(const MetricEntry (&entries)[N], MetricIndices<I...>)
+        : _slots { metricSlot(entries, I)... }
+    {
+    }
+
+    //* O(1) lookup. Returns false if key is not part of the table
+    bool lookup(int key, int &value) const
+    {
+        if (key < 0 || key >= Size || !_slots[key].valid) {
+            return false;
+        }
+
+        value = _slots[key].value;
+        return true;
+    }
+
+private:
+    //* values, and whether they are defined
+    MetricSlot _slots[Size];
+};
+
+static_assert(metricKeysFit(staticPixelMetrics, MetricTable::Size), "pixel metric out of the table range");
+static_assert(metricKeysFit(staticStyleHints, MetricTable::Size), "style hint out of the table range");
+
+static constexpr MetricTable pixelMetricTable(staticPixelMetrics, MakeMetricIndices<MetricTable::Size>::type());
+static constexpr MetricTable styleHintTable(staticStyleHints, MakeMetricIndices<MetricTable::Size>::type());
+
+//* how far draw calls may paint outside of option->rect
+/**
+ * outlines and focus frames are drawn with a one pixel pen on the rect edges, and antialiasing
+ * can touch one more pixel. Overlapping tabs are already part of their tab rects, and the title
+ * bar clips its oversized frame to the option rect
+ */
+static const int ClipMargin = 2;
+
+//* dispatch table lookup. Returns nullptr for elements out of the table range
+template<typename T, std::size_t N>
+inline T dispatch(const T (&table)[N], int element)
+{
+    return (element >= 0 && std::size_t(element) < N) ? table[element] : nullptr;
+}
+
+//* true if a primitive covers its whole rect, rather than drawing an outline, a glyph or nothing
+/** only those count as one layer in the overdraw heat map */
+inline bool fillsRect(QStyle::PrimitiveElement element, const QStyleOption *option)
+{
+    const QStyle::State &state(option->state);
+    switch (element) {
+    case QStyle::PE_FrameLineEdit:
+    case QStyle::PE_PanelLineEdit:
+    case QStyle::PE_PanelMenu:
+    case QStyle::PE_PanelTipLabel:
+    case QStyle::PE_PanelScrollAreaCorner:
+    case QStyle::PE_IndicatorCheckBox:
+    case QStyle::PE_IndicatorRadioButton:
+        return true;
+
+    // flat buttons only fill when hovered or pressed
+    case QStyle::PE_PanelButtonCommand: {
+        const QStyleOptionButton *buttonOption(qstyleoption_cast<const QStyleOptionButton *>(option));
+        return !(buttonOption && (buttonOption->features & QStyleOptionButton::Flat))
+               || (state & (QStyle::State_MouseOver | QStyle::State_Sunken | QStyle::State_On));
+    }
+
+    case QStyle::PE_PanelButtonTool:
+        return !(state & QStyle::State_AutoRaise) || (state & (QStyle::State_MouseOver | QStyle::State_Sunken | QStyle::State_On));
+
+    // rows and items only fill when selected, or for a custom background
+    case QStyle::PE_PanelItemViewRow:
+        return state & QStyle::State_Selected;
+
+    case QStyle::PE_PanelItemViewItem: {
+        const QStyleOptionViewItem *viewItemOption(qstyleoption_cast<const QStyleOptionViewItem *>(option));
+        return (state & QStyle::State_Selected) || (viewItemOption && viewItemOption->backgroundBrush.style() != Qt::NoBrush);
+    }
+
+    default:
+        return false;
+    }
+}
+
+using Adwaita::HashValue;
+using Adwaita::hashValues;
+
+//* everything subControlRect depends on for the complex controls that are hit tested on mouse move
+struct SubControlRectKey {
+    int control = 0;
+    QRect rect;
+    int direction = 0;
+    int horizontal = 0;
+    int orientation = 0;
+    int minimum = 0;
+    int maximum = 0;
+    int sliderPosition = 0;
+    int pageStep = 0;
+    int upsideDown = 0;
+    int tickPosition = 0;
+    int tickInterval = 0;
+    int frame = 0;
+    int editable = 0;
+    int buttonSymbols = 0;
+    int fontHeight = 0;
+
+    //* equal to operator
+    bool operator==(const SubControlRectKey &other) const
+    {
+        return control == other.control
+               && rect == other.rect
+               && direction == other.direction
+               && horizontal == other.horizontal
+               && orientation == other.orientation
+               && minimum == other.minimum
+               && maximum == other.maximum
+               && sliderPosition == other.sliderPosition
+               && pageStep == other.pageStep
+               && upsideDown == other.upsideDown
+               && tickPosition == other.tickPosition
+               && tickInterval == other.tickInterval
+               && frame == other.frame
+               && editable == other.editable
+               && buttonSymbols == other.buttonSymbols
+               && fontHeight == other.fontHeight;
+    }
+};
+
+//* hash
+inline HashValue qHash(const SubControlRectKey &key, HashValue seed = 0)
+{
+    return hashValues(seed, key.control, key.rect.x(), key.rect.y(), key.rect.width(), key.rect.height(),
+                      key.direction, key.horizontal, key.orientation,
+                      key.minimum, key.maximum, key.sliderPosition, key.pageStep, key.upsideDown,
+                      key.tickPosition, key.tickInterval, key.frame, key.editable, key.buttonSymbols, key.fontHeight);
+}
+
+//* caches the sub control rects computed for a given control geometry
+/**
+ * scrollbar, spinbox, combobox and slider hit testing runs on every mouse move
+ * and asks for each sub control rect in turn. Once a geometry has been seen,
+ * this reduces it to a hash lookup.
+ */
+class SubControlRectCache
+{
+public:
+    //* max number of geometries kept before the cache is flushed
+    enum { MaxSize = 256 };
+
+    //* fill key from option. Returns false if control is not cached
+    static bool key(QStyle::ComplexControl control, const QStyleOptionComplex *option, SubControlRectKey &key)
+    {
+        if (!option) {
+            return false;
+        }
+
+        key.control = control;
+        key.rect = option->rect;
+        key.direction = option->direction;
+        key.horizontal = bool(option->state & QStyle::State_Horizontal);
+        key.fontHeight = option->fontMetrics.height();
+
+        switch (control) {
+        case QStyle::CC_ScrollBar:
+        case QStyle::CC_Slider: {
+            const QStyleOptionSlider *sliderOption(qstyleoption_cast<const QStyleOptionSlider *>(option));
+            if (!sliderOption) {
+                return false;
+            }
+
+            key.orientation = sliderOption->orientation;
+            key.minimum = sliderOption->minimum;
+            key.maximum = sliderOption->maximum;
+            key.sliderPosition = sliderOption->sliderPosition;
+            key.pageStep = sliderOption->pageStep;
+            key.upsideDown = sliderOption->upsideDown;
+            key.tickPosition = sliderOption->tickPosition;
+            key.tickInterval = sliderOption->tickInterval;
+            return true;
+        }
+
+        case QStyle::CC_SpinBox: {
+            const QStyleOptionSpinBox *spinBoxOption(qstyleoption_cast<const QStyleOptionSpinBox *>(option));
+            if (!spinBoxOption) {
+                return false;
+            }
+
+            key.frame = spinBoxOption->frame;
+            key.buttonSymbols = spinBoxOption->buttonSymbols;
+            return true;
+        }
+
+        case QStyle::CC_ComboBox: {
+            const QStyleOptionComboBox *comboBoxOption(qstyleoption_cast<const QStyleOptionComboBox *>(option));
+            if (!comboBoxOption) {
+                return false;
+            }
+
+            key.frame = comboBoxOption->frame;
+            key.editable = comboBoxOption->editable;
+            return true;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    //* retrieve cached rect, if any
+    bool find(const SubControlRectKey &key, QStyle::SubControl subControl, QRect &rect) const
+    {
+        int index(this->index(subControl));
+        if (index < 0) {
+            return false;
+        }
+
+        auto iter(_entries.constFind(key));
+        if (iter == _entries.constEnd() || !(iter->valid & (1 << index))) {
+            ++_misses;
+            return false;
+        }
+
+        ++_hits;
+        rect = iter->rects[index];
+        return true;
+    }
+
+    //* store rect
+    void insert(const SubControlRectKey &key, QStyle::SubControl subControl, const QRect &rect)
+    {
+        int index(this->index(subControl));
+        if (index < 0) {
+            return;
+        }
+
+        if (_entries.size() >= MaxSize && !_entries.contains(key)) {
+            _entries.clear();
+        }
+
+        Entry &entry(_entries[key]);
+        entry.rects[index] = rect;
+        entry.valid |= (1 << index);
+    }
+
+    //* clear
+    void clear(void)
+    {
+        _entries.clear();
+    }
+
+    //* hit and size counters, sizes are in geometries
+    Adwaita::Renderer::CacheStatistics statistics(void) const
+    {
+        Adwaita::Renderer::CacheStatistics statistics;
+        statistics.hits = _hits;
+        statistics.misses = _misses;
+        statistics.count = _entries.size();
+        statistics.maxCount = MaxSize;
+        statistics.entries = statistics.count;
+        statistics.bytes = qint64(statistics.count) * qint64(sizeof(SubControlRectKey) + sizeof(Entry));
+        return statistics;
+    }
+
+    //* reset hit and miss counters
+    void resetStatistics(void)
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    //* max number of sub controls per control
+    enum { MaxSubControls = 16 };
+
+    //* bit index of a single sub control, -1 for combinations
+    static int index(QStyle::SubControl subControl)
+    {
+        const uint value(subControl);
+        if (value == 0 || (value & (value - 1))) {
+            return -1;
+        }
+
+        for (int index = 0; index < MaxSubControls; ++index) {
+            if (value == (1u << index)) {
+                return index;
+            }
+        }
+
+        return -1;
+    }
+
+    //* all sub control rects for one geometry
+    struct Entry {
+        QRect rects[MaxSubControls];
+        uint valid = 0;
+    };
+
+    QHash<SubControlRectKey, Entry> _entries;
+    mutable quint64 _hits = 0;
+    mutable quint64 _misses = 0;
+};
+
+//* everything a tree branch indicator depends on
+struct BranchGlyphKey {
+    QSize size;
+    int state = 0;
+    int direction = 0;
+    QRgb arrowColor = 0;
+    QRgb lineColor = 0;
+    int devicePixelRatio = 100;
+
+    //* equal to operator
+    bool operator==(const BranchGlyphKey &other) const
+    {
+        return size == other.size
+               && state == other.state
+               && direction == other.direction
+               && arrowColor == other.arrowColor
+               && lineColor == other.lineColor
+               && devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+//* hash
+inline HashValue qHash(const BranchGlyphKey &key, HashValue seed = 0)
+{
+    return hashValues(seed, key.size.width(), key.size.height(), key.state, key.direction,
+                      key.arrowColor, key.lineColor, key.devicePixelRatio);
+}
+
+//* pre-rendered tree branch indicators
+/**
+ * tree views paint one branch indicator per visible row and indentation level,
+ * all sharing the same geometry. Each state combination is rendered once and blitted afterwards
+ */
+class BranchGlyphCache
+{
+public:
+    //* max number of cached pixels
+    enum { MaxCost = 1 << 20 };
+
+    //* constructor
+    BranchGlyphCache(void)
+        : _pixmaps(MaxCost)
+    {}
+
+    //* cached pixmap, or nullptr
+    const QPixmap *find(const BranchGlyphKey &key) const
+    {
+        const QPixmap *pixmap(_pixmaps.object(key));
+        ++(pixmap ? _hits : _misses);
+        return pixmap;
+    }
+
+    //* store pixmap. Returns false if it is too large to be cached
+    bool insert(const BranchGlyphKey &key, const QPixmap &pixmap)
+    {
+        return _pixmaps.insert(key, new QPixmap(pixmap), pixmap.width() * pixmap.height());
+    }
+
+    //* clear
+    void clear(void)
+    {
+        _pixmaps.clear();
+    }
+
+    //* hit and size counters, sizes are in pixels
+    Adwaita::Renderer::CacheStatistics statistics(void) const
+    {
+        Adwaita::Renderer::CacheStatistics statistics;
+        statistics.hits = _hits;
+        statistics.misses = _misses;
+        statistics.count = _pixmaps.totalCost();
+        statistics.maxCount = _pixmaps.maxCost();
+        statistics.entries = _pixmaps.count();
+        statistics.bytes = qint64(statistics.count) * 4;
+        return statistics;
+    }
+
+    //* reset hit and miss counters
+    void resetStatistics(void)
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    QCache<BranchGlyphKey, QPixmap> _pixmaps;
+    mutable quint64 _hits = 0;
+    mutable quint64 _misses = 0;
+};
+
+//* key for cached tab shapes
+struct TabShapeKey {
+    QSize size;
+    int corners = 0;
+    bool renderFrame = false;
+    QRgb background = 0;
+    QRgb underline = 0;
+    QRgb outline = 0;
+
+    //* an invalid outline draws no frame, and has the same rgba as opaque black
+    bool outlineValid = false;
+
+    int devicePixelRatio = 100;
+
+    //* equal to operator
+    bool operator==(const TabShapeKey &other) const
+    {
+        return size == other.size
+               && corners == other.corners
+               && renderFrame == other.renderFrame
+               && background == other.background
+               && underline == other.underline
+               && outline == other.outline
+               && outlineValid == other.outlineValid
+               && devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+//* hash
+inline HashValue qHash(const TabShapeKey &key, HashValue seed = 0)
+{
+    return hashValues(seed, key.size.width(), key.size.height(), key.corners, int(key.renderFrame),
+                      key.background, key.underline, key.outline, int(key.outlineValid), key.devicePixelRatio);
+}
+
+//* pre-rendered tab backgrounds
+/**
+ * tab bars repaint every tab when one of them changes. Tabs of the same size
+ * and state look identical, so each combination is rendered once and blitted afterwards
+ */
+class TabShapeCache
+{
+public:
+    //* max number of cached pixels
+    enum { MaxCost = 1 << 21 };
+
+    //* constructor
+    TabShapeCache(void)
+        : _pixmaps(MaxCost)
+    {}
+
+    //* cached pixmap, or nullptr
+    const QPixmap *find(const TabShapeKey &key) const
+    {
+        const QPixmap *pixmap(_pixmaps.object(key));
+        ++(pixmap ? _hits : _misses);
+        return pixmap;
+    }
+
+    //* store pixmap. Returns false if it is too large to be cached
+    bool insert(const TabShapeKey &key, const QPixmap &pixmap)
+    {
+        return _pixmaps.insert(key, new QPixmap(pixmap), pixmap.width() * pixmap.height());
+    }
+
+    //* clear
+    void clear(void)
+    {
+        _pixmaps.clear();
+    }
+
+    //* hit and size counters, sizes are in pixels
+    Adwaita::Renderer::CacheStatistics statistics(void) const
+    {
+        Adwaita::Renderer::CacheStatistics statistics;
+        statistics.hits = _hits;
+        statistics.misses = _misses;
+        statistics.count = _pixmaps.totalCost();
+        statistics.maxCount = _pixmaps.maxCost();
+        statistics.entries = _pixmaps.count();
+        statistics.bytes = qint64(statistics.count) * 4;
+        return statistics;
+    }
+
+    //* reset hit and miss counters
+    void resetStatistics(void)
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    QCache<TabShapeKey, QPixmap> _pixmaps;
+    mutable quint64 _hits = 0;
+    mutable quint64 _misses = 0;
+};
+
+//* key for cached slider tick marks
+struct SliderTickKey {
+    QSize size;
+    QRect grooveRect;
+    int tickPosition = 0;
+    bool horizontal = true;
+    bool upsideDown = false;
+    int minimum = 0;
+    int maximum = 0;
+    int interval = 0;
+    int available = 0;
+    int fudge = 0;
+    QRgb color = 0;
+    int devicePixelRatio = 100;
+
+    //* equal to operator
+    bool operator==(const SliderTickKey &other) const
+    {
+        return size == other.size
+               && grooveRect == other.grooveRect
+               && tickPosition == other.tickPosition
+               && horizontal == other.horizontal
+               && upsideDown == other.upsideDown
+               && minimum == other.minimum
+               && maximum == other.maximum
+               && interval == other.interval
+               && available == other.available
+               && fudge == other.fudge
+               && color == other.color
+               && devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+//* hash
+inline HashValue qHash(const SliderTickKey &key, HashValue seed = 0)
+{
+    return hashValues(seed, key.size.width(), key.size.height(),
+                      key.grooveRect.x(), key.grooveRect.y(), key.grooveRect.width(), key.grooveRect.height(),
+                      key.tickPosition, int(key.horizontal), int(key.upsideDown),
+                      key.minimum, key.maximum, key.interval, key.available, key.fudge,
+                      key.color, key.devicePixelRatio);
+}
+
+//* pre-rendered slider tick marks
+/**
+ * ticks only depend on the slider geometry and range, not on its value.
+ * They are rendered once into a layer covering their bounding rect,
+ * so that moving the handle only blits them
+ */
+class SliderTickCache
+{
+public:
+    //* max number of cached pixels
+    enum { MaxCost = 1 << 21 };
+
+    //* cached layer
+    struct Layer {
+        QPixmap pixmap;
+
+        //* position of the pixmap, relative to the slider rect
+        QPoint offset;
+    };
+
+    //* constructor
+    SliderTickCache(void)
+        : _layers(MaxCost)
+    {}
+
+    //* cached layer, or nullptr
+    const Layer *find(const SliderTickKey &key) const
+    {
+        const Layer *layer(_layers.object(key));
+        ++(layer ? _hits : _misses);
+        return layer;
+    }
+
+    //* store layer. Returns false if it is too large to be cached
+    bool insert(const SliderTickKey &key, const Layer &layer)
+    {
+        return _layers.insert(key, new Layer(layer), qMax(1, layer.pixmap.width() * layer.pixmap.height()));
+    }
+
+    //* clear
+    void clear(void)
+    {
+        _layers.clear();
+    }
+
+    //* hit and size counters, sizes are in pixels
+    Adwaita::Renderer::CacheStatistics statistics(void) const
+    {
+        Adwaita::Renderer::CacheStatistics statistics;
+        statistics.hits = _hits;
+        statistics.misses = _misses;
+        statistics.count = _layers.totalCost();
+        statistics.maxCount = _layers.maxCost();
+        statistics.entries = _layers.count();
+        statistics.bytes = qint64(statistics.count) * 4;
+        return statistics;
+    }
+
+    //* reset hit and miss counters
+    void resetStatistics(void)
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    QCache<SliderTickKey, Layer> _layers;
+    mutable quint64 _hits = 0;
+    mutable quint64 _misses = 0;
+};
+
+//* slider tick lines, one per distinct pixel position
+/**
+ * with fine intervals many values map to the same position, only the first one is kept
+ */
+static QVector<QLine> sliderTickLines(const QStyleOptionSlider *sliderOption, const QRect &grooveRect, int interval, int available, int fudge)
+{
+    const QRect &rect(sliderOption->rect);
+    const bool horizontal(sliderOption->orientation == Qt::Horizontal);
+    const int tickPosition(sliderOption->tickPosition);
+
+    // tick lines at value zero, one per side
+    QVector<QLine> tickLines;
+    if (horizontal) {
+        if (tickPosition & QSlider::TicksAbove) {
+            tickLines.append(QLine(rect.left(), grooveRect.top() - Adwaita::Metrics::Slider_TickMarginWidth, rect.left(), grooveRect.top() - Adwaita::Metrics::Slider_TickMarginWidth - Adwaita::Metrics::Slider_TickLength));
+        }
+        if (tickPosition & QSlider::TicksBelow) {
+            tickLines.append(QLine(rect.left(), grooveRect.bottom() + Adwaita::Metrics::Slider_TickMarginWidth, rect.left(), grooveRect.bottom() + Adwaita::Metrics::Slider_TickMarginWidth + Adwaita::Metrics::Slider_TickLength));
+        }
+    } else {
+        if (tickPosition & QSlider::TicksAbove) {
+            tickLines.append(QLine(grooveRect.left() - Adwaita::Metrics::Slider_TickMarginWidth, rect.top(), grooveRect.left() - Adwaita::Metrics::Slider_TickMarginWidth - Adwaita::Metrics::Slider_TickLength, rect.top()));
+        }
+        if (tickPosition & QSlider::TicksBelow) {
+            tickLines.append(QLine(grooveRect.right() + Adwaita::Metrics::Slider_TickMarginWidth, rect.top(), grooveRect.right() + Adwaita::Metrics::Slider_TickMarginWidth + Adwaita::Metrics::Slider_TickLength, rect.top()));
+        }
+    }
+
+    QVector<QLine> lines;
+    if (tickLines.isEmpty()) {
+        return lines;
+    }
+
+    int lastPosition(-1);
+
+    // 64 bits, so that the last increment cannot overflow
+    for (qint64 current = sliderOption->minimum; current <= sliderOption->maximum; current += interval) {
+        const int position(QStyle::sliderPositionFromValue(sliderOption->minimum, sliderOption->maximum, int(current), available) + fudge);
+        if (position == lastPosition) {
+            continue;
+        }
+
+        lastPosition = position;
+        for (const QLine &tickLine : tickLines) {
+            if (horizontal) {
+                lines.append(tickLine.translated(sliderOption->upsideDown ? (rect.width() - position) : position, 0));
+            } else {
+                lines.append(tickLine.translated(0, sliderOption->upsideDown ? (rect.height() - position) : position));
+            }
+        }
+    }
+
+    return lines;
+}
+
 } // namespace AdwaitaPrivate
 
 void tabLayout(const QStyleOptionTab *opt, const QWidget *widget, QRect *textRect, QRect *iconRect, const QStyle *proxyStyle)
@@ -224,12 +1048,17 @@ Style::Style(ColorVariant variant)
     : _addLineButtons(SingleButton)
     , _subLineButtons(SingleButton)
     , _helper(new Helper())
+    , _runtimeConfig(new RuntimeConfig(this))
     , _animations(new Animations(this))
     , _mnemonics(new Mnemonics(this))
     , _windowManager(new WindowManager(this))
     , _splitterFactory(new SplitterFactory(this))
     , _widgetExplorer(new WidgetExplorer(this))
     , _tabBarData(new AdwaitaPrivate::TabBarData(this))
+    , _subControlRectCache(new AdwaitaPrivate::SubControlRectCache())
+    , _branchGlyphCache(new AdwaitaPrivate::BranchGlyphCache())
+    , _tabShapeCache(new AdwaitaPrivate::TabShapeCache())
+    , _sliderTickCache(new AdwaitaPrivate::SliderTickCache())
     , _variant(variant)
     , _dark(variant == AdwaitaDark || variant == AdwaitaHighcontrastInverse)
 {
@@ -238,6 +1067,14 @@ Style::Style(ColorVariant variant)
     _isKDE = qgetenv("XDG_CURRENT_DESKTOP").toLower() == "kde";
     _isGNOME = qgetenv("XDG_CURRENT_DESKTOP").toLower() == "gnome";
 
+    // live counters on the session bus, owned by the style
+    if (!qEnvironmentVariableIsEmpty("ADWAITA_DBUS_COUNTERS")) {
+        new DBusCounters(this);
+    }
+
+    // follow edits to the settings file
+    connect(_runtimeConfig, &RuntimeConfig::changed, this, &Style::configurationChanged);
+
     // call the slot directly; this initial call will set up things that also
     // need to be reset when the system palette changes
     loadConfiguration();
@@ -246,12 +1083,18 @@ Style::Style(ColorVariant variant)
 //______________________________________________________________
 Style::~Style(void)
 {
+    delete _subControlRectCache;
+    delete _branchGlyphCache;
+    delete _tabShapeCache;
+    delete _sliderTickCache;
     delete _helper;
 }
 
 //______________________________________________________________
 void Style::polish(QWidget *widget)
 {
+    const Tracer::Event trace("polish", "polish", widget, widget ? widget->size() : QSize());
+
     if (!widget) {
         return;
     }
@@ -506,9 +1349,105 @@ QPalette Style::standardPalette() const
     return Colors::palette(_variant);
 }
 
+//______________________________________________________________
+void Style::polish(QApplication *application)
+{
+    ParentStyleClass::polish(application);
+
+    // follow the desktop dark mode toggle. Styles created for single widgets or previews do not.
+    // The variant picked at startup is kept until the desktop actually switches
+    if (isApplicationStyle()) {
+        if (ColorScheme *colorScheme = ColorScheme::instance()) {
+            connect(colorScheme, &ColorScheme::toggled, this, &Style::colorSchemeChanged, Qt::UniqueConnection);
+        }
+    }
+}
+
+//______________________________________________________________
+void Style::unpolish(QApplication *application)
+{
+    if (ColorScheme *colorScheme = ColorScheme::instance()) {
+        disconnect(colorScheme, &ColorScheme::toggled, this, &Style::colorSchemeChanged);
+    }
+
+    ParentStyleClass::unpolish(application);
+}
+
+//______________________________________________________________
+bool Style::isApplicationStyle(void) const
+{
+    if (!qobject_cast<QApplication *>(qApp)) {
+        return false;
+    }
+
+    // walk down proxy styles to the base style
+    const QStyle *style(QApplication::style());
+    while (style && style != this) {
+        const QProxyStyle *proxyStyle(qobject_cast<const QProxyStyle *>(style));
+        style = proxyStyle ? proxyStyle->baseStyle() : nullptr;
+    }
+
+    return style == this;
+}
+
+//______________________________________________________________
+void Style::setColorVariant(ColorVariant variant)
+{
+    if (variant == _variant || variant == Unknown) {
+        return;
+    }
+
+    _variant = variant;
+    _dark = (variant == AdwaitaDark || variant == AdwaitaHighcontrastInverse);
+
+    // the application palette belongs to the application style only. Setting it goes through
+    // polish(QPalette&), and sends one palette change to each widget
+    if (isApplicationStyle()) {
+        QApplication::setPalette(Colors::palette(_variant));
+    }
+
+    // icons and pre-rendered glyphs
+    loadConfiguration(PalettePart);
+}
+
+//______________________________________________________________
+bool Style::setColorVariant(const QString &key)
+{
+    const ColorVariant variant(variantForKey(key));
+    if (variant == Unknown) {
+        return false;
+    }
+
+    setColorVariant(variant);
+    return true;
+}
+
+//______________________________________________________________
+ColorVariant Style::variantForKey(const QString &key)
+{
+    const QString lower(key.toLower());
+    if (lower == QStringLiteral("adwaita")) {
+        return Adwaita;
+    } else if (lower == QStringLiteral("adwaita-dark")) {
+        return AdwaitaDark;
+    } else if (lower == QStringLiteral("adwaita-highcontrast") || lower == QStringLiteral("highcontrast")) {
+        return AdwaitaHighcontrast;
+    } else if (lower == QStringLiteral("adwaita-highcontrastinverse") || lower == QStringLiteral("highcontrastinverse")) {
+        return AdwaitaHighcontrastInverse;
+    }
+
+    return Unknown;
+}
+
 //______________________________________________________________
 int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const
 {
+    // option independent metrics
+    int value;
+    if (AdwaitaPrivate::pixelMetricTable.lookup(metric, value)) {
+        return value;
+    }
+
     // handle special cases
     switch (metric) {
 
@@ -542,12 +1481,6 @@ int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWi
         const QStyleOptionComboBox *comboBoxOption(qstyleoption_cast< const QStyleOptionComboBox *>(option));
         return comboBoxOption && comboBoxOption->editable ? Metrics::LineEdit_FrameWidth : Metrics::ComboBox_FrameWidth;
     }
-    case PM_SpinBoxFrameWidth:
-        return Metrics::SpinBox_FrameWidth;
-    case PM_ToolBarFrameWidth:
-        return Metrics::ToolBar_FrameWidth;
-    case PM_ToolTipLabelFrameWidth:
-        return Metrics::ToolTip_FrameWidth;
 
     // layout
     case PM_LayoutLeftMargin:
@@ -566,10 +1499,6 @@ int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWi
             return Metrics::Layout_ChildMarginWidth;
         }
     }
-    case PM_LayoutHorizontalSpacing:
-        return Metrics::Layout_DefaultSpacing;
-    case PM_LayoutVerticalSpacing:
-        return Metrics::Layout_DefaultSpacing;
 
     // buttons
     case PM_ButtonMargin: {
@@ -581,110 +1510,23 @@ int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWi
         }
     }
 
-    case PM_ButtonDefaultIndicator:
-        return 0;
-    case PM_ButtonShiftHorizontal:
-        return 0;
-    case PM_ButtonShiftVertical:
-        return 0;
-
-    // menubars
-    case PM_MenuBarPanelWidth:
-        return 0;
-    case PM_MenuBarHMargin:
-        return 0;
-    case PM_MenuBarVMargin:
-        return 0;
-    case PM_MenuBarItemSpacing:
-        return 0;
-    case PM_MenuDesktopFrameWidth:
-        return 0;
-
     // menu buttons
-    case PM_MenuButtonIndicator:
-        return Metrics::MenuButton_IndicatorWidth;
-    case PM_MenuVMargin:
-        return 2;
     case PM_MenuHMargin:
         return _isGNOME ? 0 : 1;
 
     // toolbars
-    case PM_ToolBarHandleExtent:
-        return Metrics::ToolBar_HandleExtent;
-    case PM_ToolBarSeparatorExtent:
-        return Metrics::ToolBar_SeparatorWidth;
     case PM_ToolBarExtensionExtent:
         return pixelMetric(PM_SmallIconSize, option, widget) + 2 * Metrics::ToolButton_MarginWidth;
 
-    case PM_ToolBarItemMargin:
-        return 0;
-    case PM_ToolBarItemSpacing:
-        return Metrics::ToolBar_ItemSpacing;
-
     // tabbars
-    case PM_TabBarTabShiftVertical:
-        return 0;
-    case PM_TabBarTabShiftHorizontal:
-        return 0;
-    case PM_TabBarTabOverlap:
-        return Metrics::TabBar_TabOverlap;
-    case PM_TabBarBaseOverlap:
-        return Metrics::TabBar_BaseOverlap;
-    case PM_TabBarTabHSpace:
-        return 2 * Metrics::TabBar_TabMarginWidth;
-    case PM_TabBarTabVSpace:
-        return 2 * Metrics::TabBar_TabMarginHeight;
     case PM_TabCloseIndicatorWidth:
     case PM_TabCloseIndicatorHeight:
         return pixelMetric(PM_SmallIconSize, option, widget);
 
-    // scrollbars
-    case PM_ScrollBarExtent:
-        return Metrics::ScrollBar_Extend;
-    case PM_ScrollBarSliderMin:
-        return Metrics::ScrollBar_MinSliderHeight;
-
     // title bar
     case PM_TitleBarHeight:
         return 2 * Metrics::TitleBar_MarginWidth + pixelMetric(PM_SmallIconSize, option, widget);
 
-    // sliders
-    case PM_SliderThickness:
-        return Metrics::Slider_ControlThickness;
-    case PM_SliderControlThickness:
-        return Metrics::Slider_ControlThickness;
-    case PM_SliderLength:
-        return Metrics::Slider_ControlThickness;
-
-    // checkboxes and radio buttons
-    case PM_IndicatorWidth:
-        return Metrics::CheckBox_Size;
-    case PM_IndicatorHeight:
-        return Metrics::CheckBox_Size;
-    case PM_ExclusiveIndicatorWidth:
-        return Metrics::CheckBox_Size;
-    case PM_ExclusiveIndicatorHeight:
-        return Metrics::CheckBox_Size;
-
-    // list heaaders
-    case PM_HeaderMarkSize:
-        return Metrics::Header_ArrowSize;
-    case PM_HeaderMargin:
-        return Metrics::Header_MarginWidth;
-
-    // dock widget
-    // return 0 here, since frame is handled directly in polish
-    case PM_DockWidgetFrameWidth:
-        return 0;
-    case PM_DockWidgetTitleMargin:
-        return Metrics::Frame_FrameWidth;
-    case PM_DockWidgetTitleBarButtonMargin:
-        return Metrics::ToolButton_MarginWidth;
-
-    case PM_SplitterWidth:
-        return Metrics::Splitter_SplitterWidth;
-    case PM_DockWidgetSeparatorExtent:
-        return Metrics::Splitter_SplitterWidth;
     // fallback
     default:
         return ParentStyleClass::pixelMetric(metric, option, widget);
@@ -694,7 +1536,16 @@ int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWi
 //______________________________________________________________
 int Style::styleHint(StyleHint hint, const QStyleOption *option, const QWidget *widget, QStyleHintReturn *returnData) const
 {
+    // option independent hints
+    int value;
+    if (AdwaitaPrivate::styleHintTable.lookup(hint, value)) {
+        return value;
+    }
+
     switch (hint) {
+    case SH_Widget_Animate:
+        return _runtimeConfig->animationsEnabled();
+
     case SH_RubberBand_Mask: {
         if (QStyleHintReturnMask *mask = qstyleoption_cast<QStyleHintReturnMask *>(returnData)) {
             mask->region = option->rect;
@@ -725,54 +1576,6 @@ int Style::styleHint(StyleHint hint, const QStyleOption *option, const QWidget *
         return false;
     }
 
-    case SH_ComboBox_ListMouseTracking:
-        return true;
-    case SH_MenuBar_MouseTracking:
-        return true;
-    case SH_Menu_MouseTracking:
-        return true;
-    case SH_Menu_SubMenuPopupDelay:
-        return 150;
-    case SH_Menu_SloppySubMenus:
-        return true;
-    case SH_Widget_Animate:
-        return Adwaita::Config::AnimationsEnabled;
-    case SH_Menu_SupportsSections:
-        return true;
-    case SH_DialogButtonBox_ButtonsHaveIcons:
-        return false;
-    case SH_GroupBox_TextLabelVerticalAlignment:
-        return Qt::AlignVCenter;
-    case SH_TabBar_Alignment:
-        return Adwaita::Config::TabBarDrawCenteredTabs ? Qt::AlignCenter : Qt::AlignLeft;
-    case SH_ToolBox_SelectedPageTitleBold:
-        return false;
-    case SH_ScrollBar_MiddleClickAbsolutePosition:
-        return true;
-    case SH_ScrollView_FrameOnlyAroundContents:
-        return false;
-    case SH_FormLayoutFormAlignment:
-        return Qt::AlignLeft | Qt::AlignTop;
-    case SH_FormLayoutLabelAlignment:
-        return Qt::AlignRight;
-    case SH_FormLayoutFieldGrowthPolicy:
-        return QFormLayout::ExpandingFieldsGrow;
-    case SH_FormLayoutWrapPolicy:
-        return QFormLayout::DontWrapRows;
-    case SH_MessageBox_TextInteractionFlags:
-        return Qt::TextSelectableByMouse | Qt::LinksAccessibleByMouse;
-    case SH_ProgressDialog_CenterCancelButton:
-        return false;
-    case SH_MessageBox_CenterButtons:
-        return false;
-    case SH_RequestSoftwareInputPanel:
-        return RSIP_OnMouseClick;
-    case SH_TitleBar_NoBorder:
-        return true;
-    case SH_DockWidget_ButtonsHaveFrame:
-        return false;
-    case SH_ToolTipLabel_Opacity:
-        return 204 ;// Should have 30% transparency
     default:
         return ParentStyleClass::styleHint(hint, option, widget, returnData);
     }
@@ -843,15 +1646,12 @@ QRect Style::subControlRect(ComplexControl element, const QStyleOptionComplex *o
     case CC_ToolButton:
         return toolButtonSubControlRect(option, subControl, widget);
     case CC_ComboBox:
-        return comboBoxSubControlRect(option, subControl, widget);
     case CC_SpinBox:
-        return spinBoxSubControlRect(option, subControl, widget);
     case CC_ScrollBar:
-        return scrollBarSubControlRect(option, subControl, widget);
+    case CC_Slider:
+        return cachedSubControlRect(element, option, subControl, widget);
     case CC_Dial:
         return dialSubControlRect(option, subControl, widget);
-    case CC_Slider:
-        return sliderSubControlRect(option, subControl, widget);
 
     // fallback
     default:
@@ -859,9 +1659,47 @@ QRect Style::subControlRect(ComplexControl element, const QStyleOptionComplex *o
     }
 }
 
+//______________________________________________________________
+QRect Style::cachedSubControlRect(ComplexControl element, const QStyleOptionComplex *option, SubControl subControl, const QWidget *widget) const
+{
+    // lookup cache. The key does not cover the widget, so only cache when metrics come from this
+    // style; a proxy style may change them per widget. The cache is not thread safe either
+    AdwaitaPrivate::SubControlRectKey key;
+    const bool cacheable(proxy() == this && canUsePixmaps() && AdwaitaPrivate::SubControlRectCache::key(element, option, key));
+    QRect rect;
+    if (cacheable && _subControlRectCache->find(key, subControl, rect)) {
+        return rect;
+    }
+
+    switch (element) {
+    case CC_ComboBox:
+        rect = comboBoxSubControlRect(option, subControl, widget);
+        break;
+    case CC_SpinBox:
+        rect = spinBoxSubControlRect(option, subControl, widget);
+        break;
+    case CC_ScrollBar:
+        rect = scrollBarSubControlRect(option, subControl, widget);
+        break;
+    case CC_Slider:
+        rect = sliderSubControlRect(option, subControl, widget);
+        break;
+    default:
+        return ParentStyleClass::subControlRect(element, option, subControl, widget);
+    }
+
+    if (cacheable) {
+        _subControlRectCache->insert(key, subControl, rect);
+    }
+
+    return rect;
+}
+
 //______________________________________________________________
 QSize Style::sizeFromContents(ContentsType element, const QStyleOption *option, const QSize &size, const QWidget *widget) const
 {
+    const Tracer::Event trace("size", Tracer::name(element), widget, size);
+
     switch (element) {
     case CT_CheckBox:
         return checkBoxSizeFromContents(option, size, widget);
@@ -947,215 +1785,165 @@ QStyle::SubControl Style::hitTestComplexControl(ComplexControl control, const QS
 }
 
 //______________________________________________________________
-void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+bool Style::isClippedOut(const QStyleOption *option, const QPainter *painter) const
 {
-    StylePrimitive fcn(nullptr);
-    switch (element) {
-    case PE_PanelButtonCommand:
-        fcn = &Style::drawPanelButtonCommandPrimitive;
-        break;
-    case PE_PanelButtonTool:
-        fcn = &Style::drawPanelButtonToolPrimitive;
-        break;
-    case PE_PanelScrollAreaCorner:
-        fcn = &Style::drawPanelScrollAreaCornerPrimitive;
-        break;
-    case PE_PanelMenu:
-        fcn = &Style::drawPanelMenuPrimitive;
-        break;
-    case PE_PanelTipLabel:
-        fcn = &Style::drawPanelTipLabelPrimitive;
-        break;
-    case PE_PanelItemViewRow:
-        fcn = &Style::drawPanelItemViewRowPrimitive;
-        break;
-    case PE_PanelItemViewItem:
-        fcn = &Style::drawPanelItemViewItemPrimitive;
-        break;
-    case PE_IndicatorCheckBox:
-        fcn = &Style::drawIndicatorCheckBoxPrimitive;
-        break;
-    case PE_IndicatorRadioButton:
-        fcn = &Style::drawIndicatorRadioButtonPrimitive;
-        break;
-    case PE_IndicatorButtonDropDown:
-        fcn = &Style::drawIndicatorButtonDropDownPrimitive;
-        break;
-    case PE_IndicatorTabClose:
-        fcn = &Style::drawIndicatorTabClosePrimitive;
-        break;
-    case PE_IndicatorTabTear:
-        fcn = &Style::drawIndicatorTabTearPrimitive;
-        break;
-    case PE_IndicatorArrowUp:
-        fcn = &Style::drawIndicatorArrowUpPrimitive;
-        break;
-    case PE_IndicatorArrowDown:
-        fcn = &Style::drawIndicatorArrowDownPrimitive;
-        break;
-    case PE_IndicatorArrowLeft:
-        fcn = &Style::drawIndicatorArrowLeftPrimitive;
-        break;
-    case PE_IndicatorArrowRight:
-        fcn = &Style::drawIndicatorArrowRightPrimitive;
-        break;
-    case PE_IndicatorHeaderArrow:
-        fcn = &Style::drawIndicatorHeaderArrowPrimitive;
-        break;
-    case PE_IndicatorToolBarHandle:
-        fcn = &Style::drawIndicatorToolBarHandlePrimitive;
-        break;
-    case PE_IndicatorToolBarSeparator:
-        fcn = &Style::drawIndicatorToolBarSeparatorPrimitive;
-        break;
-    case PE_IndicatorBranch:
-        fcn = &Style::drawIndicatorBranchPrimitive;
-        break;
-    case PE_FrameStatusBarItem:
-        fcn = &Style::emptyPrimitive;
-        break;
-    case PE_Frame:
-        fcn = &Style::drawFramePrimitive;
-        break;
-    case PE_FrameLineEdit:
-        fcn = &Style::drawFrameLineEditPrimitive;
-        break;
-    case PE_FrameMenu:
-        fcn = &Style::drawFrameMenuPrimitive;
-        break;
-    case PE_FrameGroupBox:
-        fcn = &Style::drawFrameGroupBoxPrimitive;
-        break;
-    case PE_FrameTabWidget:
-        fcn = &Style::drawFrameTabWidgetPrimitive;
-        break;
-    case PE_FrameTabBarBase:
-        fcn = &Style::drawFrameTabBarBasePrimitive;
-        break;
-    case PE_FrameWindow:
-        fcn = &Style::drawFrameWindowPrimitive;
-        break;
-    case PE_FrameFocusRect:
-        fcn = _frameFocusPrimitive;
-        break;
-    // fallback
-    default:
-        break;
+    if (!(option && painter) || option->rect.isEmpty()) {
+        return false;
     }
 
-    painter->save();
+    // painter clip, in logical coordinates
+    bool clipped(painter->hasClipping());
+    QRectF clipRect(clipped ? painter->clipBoundingRect() : QRectF());
 
-    // call function if implemented
-    if (!(fcn && (this->*fcn)(option, painter, widget))) {
-        ParentStyleClass::drawPrimitive(element, option, painter, widget);
+    // partial widget updates, such as scroll blits and single cells of item views, restrict
+    // painting through the system clip instead. It is in device coordinates
+    if (const QPaintEngine *engine = painter->paintEngine()) {
+        const QRegion systemClip(engine->systemClip());
+        bool invertible(false);
+        const QTransform inverse(painter->deviceTransform().inverted(&invertible));
+        if (!systemClip.isEmpty() && invertible) {
+            const QRectF systemRect(inverse.mapRect(QRectF(systemClip.boundingRect())));
+            clipRect = clipped ? clipRect.intersected(systemRect) : systemRect;
+            clipped = true;
+        }
     }
 
-    painter->restore();
+    // leave room for antialiased edges and outlines drawn across the rect boundary
+    if (!clipped || clipRect.intersects(QRectF(option->rect).adjusted(-AdwaitaPrivate::ClipMargin, -AdwaitaPrivate::ClipMargin, AdwaitaPrivate::ClipMargin, AdwaitaPrivate::ClipMargin))) {
+        return false;
+    }
+
+    ++_rejectedDrawCalls;
+    return true;
 }
 
 //______________________________________________________________
-void Style::drawControl(ControlElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+QMap<QString, Renderer::CacheStatistics> Style::cacheStatistics(void) const
 {
-    StyleControl fcn(nullptr);
-    switch (element) {
-    case CE_PushButtonBevel:
-        fcn = &Style::drawPanelButtonCommandPrimitive;
-        break;
-    case CE_PushButtonLabel:
-        fcn = &Style::drawPushButtonLabelControl;
-        break;
-    case CE_CheckBoxLabel:
-        fcn = &Style::drawCheckBoxLabelControl;
-        break;
-    case CE_RadioButtonLabel:
-        fcn = &Style::drawCheckBoxLabelControl;
-        break;
-    case CE_ToolButtonLabel:
-        fcn = &Style::drawToolButtonLabelControl;
-        break;
-    case CE_ComboBoxLabel:
-        fcn = &Style::drawComboBoxLabelControl;
-        break;
-    case CE_MenuBarEmptyArea:
-        fcn = &Style::drawMenuBarEmptyArea;
-        break;
-    case CE_MenuBarItem:
-        fcn = &Style::drawMenuBarItemControl;
-        break;
-    case CE_MenuItem:
-        fcn = &Style::drawMenuItemControl;
-        break;
-    case CE_ToolBar:
-        fcn = &Style::emptyControl;
-        break;
-    case CE_ProgressBar:
-        fcn = &Style::drawProgressBarControl;
-        break;
-    case CE_ProgressBarContents:
-        fcn = &Style::drawProgressBarContentsControl;
-        break;
-    case CE_ProgressBarGroove:
-        fcn = &Style::drawProgressBarGrooveControl;
-        break;
-    case CE_ProgressBarLabel:
-        fcn = &Style::drawProgressBarLabelControl;
-        break;
-    case CE_ScrollBarSlider:
-        fcn = &Style::drawScrollBarSliderControl;
-        break;
-    case CE_ScrollBarAddLine:
-        fcn = &Style::drawScrollBarAddLineControl;
-        break;
-    case CE_ScrollBarSubLine:
-        fcn = &Style::drawScrollBarSubLineControl;
-        break;
-    case CE_ScrollBarAddPage:
-        fcn = &Style::emptyControl;
-        break;
-    case CE_ScrollBarSubPage:
-        fcn = &Style::emptyControl;
-        break;
-    case CE_ShapedFrame:
-        fcn = &Style::drawShapedFrameControl;
-        break;
-    case CE_RubberBand:
-        fcn = &Style::drawRubberBandControl;
-        break;
-    case CE_SizeGrip:
-        fcn = &Style::emptyControl;
-        break;
-    case CE_HeaderSection:
-        fcn = &Style::drawHeaderSectionControl;
-        break;
-    case CE_HeaderLabel:
-        fcn = &Style::drawHeaderLabelControl;
-        break;
-    case CE_HeaderEmptyArea:
-        fcn = &Style::drawHeaderEmptyAreaControl;
-        break;
-    case CE_TabBarTabLabel:
-        fcn = &Style::drawTabBarTabLabelControl;
-        break;
-    case CE_TabBarTabShape:
-        fcn = &Style::drawTabBarTabShapeControl;
-        break;
-    case CE_ToolBoxTabLabel:
-        fcn = &Style::drawToolBoxTabLabelControl;
-        break;
-    case CE_ToolBoxTabShape:
-        fcn = &Style::drawToolBoxTabShapeControl;
-        break;
-    case CE_DockWidgetTitle:
-        fcn = &Style::drawDockWidgetTitleControl;
-        break;
-    case CE_ItemViewItem:
-        fcn = &Style::drawItemViewItemControl;
-        break;
-    // fallback
-    default:
-        break;
+    QMap<QString, Renderer::CacheStatistics> statistics;
+    statistics.insert(QStringLiteral("paths"), Renderer::pathCacheStatistics());
+    statistics.insert(QStringLiteral("glyphs"), Renderer::glyphCacheStatistics());
+    statistics.insert(QStringLiteral("indicatorSprites"), Renderer::indicatorSpriteCacheStatistics());
+    statistics.insert(QStringLiteral("subControlRects"), _subControlRectCache->statistics());
+    statistics.insert(QStringLiteral("branchGlyphs"), _branchGlyphCache->statistics());
+    statistics.insert(QStringLiteral("tabShapes"), _tabShapeCache->statistics());
+    statistics.insert(QStringLiteral("sliderTicks"), _sliderTickCache->statistics());
+    return statistics;
+}
+
+//______________________________________________________________
+QMap<QString, int> Style::animationDataCounts(void) const
+{
+    return _animations->dataCounts();
+}
+
+//______________________________________________________________
+QMap<QString, Style::MemoryUsage> Style::memoryUsage(void) const
+{
+    const auto entry = [](int objects, qint64 bytes) {
+        MemoryUsage usage;
+        usage.objects = objects;
+        usage.bytes = bytes;
+        return usage;
+    };
+
+    QMap<QString, MemoryUsage> usage;
+
+    // style and renderer caches
+    const QMap<QString, Renderer::CacheStatistics> caches(cacheStatistics());
+    for (auto iter = caches.constBegin(); iter != caches.constEnd(); ++iter) {
+        usage.insert(QStringLiteral("caches/") + iter.key(), entry(iter.value().entries, iter.value().bytes));
+    }
+
+    // animation data objects, and the pixmaps held by transitions
+    const QMap<QString, int> dataCounts(_animations->dataCounts());
+    const QMap<QString, qint64> pixmapBytes(_animations->pixmapBytes());
+    for (auto iter = dataCounts.constBegin(); iter != dataCounts.constEnd(); ++iter) {
+        usage.insert(QStringLiteral("animations/") + iter.key(), entry(iter.value(), pixmapBytes.value(iter.key())));
+    }
+
+    // standard icons
+    qint64 iconBytes(0);
+    for (const QIcon &icon : _iconCache) {
+        for (const QSize &size : icon.availableSizes()) {
+            iconBytes += qint64(size.width()) * size.height() * 4;
+        }
+    }
+    usage.insert(QStringLiteral("icons"), entry(_iconCache.size(), iconBytes));
+
+    // splitter proxies are plain widgets, only count them
+    usage.insert(QStringLiteral("splitterProxies"), entry(_splitterFactory->proxyCount(), 0));
+
+    // color tables
+    usage.insert(QStringLiteral("colorTables"), entry(Colors::colorTableEntries(), Colors::colorTableBytes()));
+
+    return usage;
+}
+
+//______________________________________________________________
+void Style::dumpMemoryUsage(void) const
+{
+    const QMap<QString, MemoryUsage> usage(memoryUsage());
+    qint64 bytes(0);
+    for (auto iter = usage.constBegin(); iter != usage.constEnd(); ++iter) {
+        qCInfo(ADWAITA_STYLE).noquote()
+                << iter.key() << "objects:" << iter.value().objects << "bytes:" << iter.value().bytes;
+        bytes += iter.value().bytes;
+    }
+
+    qCInfo(ADWAITA_STYLE) << "total bytes:" << bytes;
+}
+
+//______________________________________________________________
+void Style::resetStatistics(void)
+{
+    Renderer::resetCacheStatistics();
+    _subControlRectCache->resetStatistics();
+    _branchGlyphCache->resetStatistics();
+    _tabShapeCache->resetStatistics();
+    _sliderTickCache->resetStatistics();
+    _rejectedDrawCalls = 0;
+    _widgetExplorer->resetProfile();
+}
+
+//______________________________________________________________
+void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+{
+    // nothing to do if outside of the area being repainted
+    if (isClippedOut(option, painter)) {
+        return;
+    }
+
+    const WidgetExplorer::Timer<PrimitiveElement> timer(_widgetExplorer, element);
+    const Tracer::Event trace("draw", Tracer::name(element), widget, option ? option->rect.size() : QSize());
+    if (option && AdwaitaPrivate::fillsRect(element, option)) {
+        _widgetExplorer->addPaintedRect(painter, option->rect);
+    }
+
+    StylePrimitive fcn(AdwaitaPrivate::dispatch(_primitives, element));
+
+    painter->save();
+
+    // call function if implemented
+    if (!(fcn && (this->*fcn)(option, painter, widget))) {
+        ParentStyleClass::drawPrimitive(element, option, painter, widget);
+    }
+
+    painter->restore();
+}
+
+//______________________________________________________________
+void Style::drawControl(ControlElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+{
+    // nothing to do if outside of the area being repainted
+    if (isClippedOut(option, painter)) {
+        return;
     }
 
+    const WidgetExplorer::Timer<ControlElement> timer(_widgetExplorer, element);
+    const Tracer::Event trace("draw", Tracer::name(element), widget, option ? option->rect.size() : QSize());
+    StyleControl fcn(AdwaitaPrivate::dispatch(_controls, element));
+
     painter->save();
 
     // call function if implemented
@@ -1169,38 +1957,15 @@ void Style::drawControl(ControlElement element, const QStyleOption *option, QPai
 //______________________________________________________________
 void Style::drawComplexControl(ComplexControl element, const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget) const
 {
-    StyleComplexControl fcn(nullptr);
-    switch (element) {
-    case CC_GroupBox:
-        fcn = &Style::drawGroupBoxComplexControl;
-        break;
-    case CC_ToolButton:
-        fcn = &Style::drawToolButtonComplexControl;
-        break;
-    case CC_ComboBox:
-        fcn = &Style::drawComboBoxComplexControl;
-        break;
-    case CC_SpinBox:
-        fcn = &Style::drawSpinBoxComplexControl;
-        break;
-    case CC_Slider:
-        fcn = &Style::drawSliderComplexControl;
-        break;
-    case CC_Dial:
-        fcn = &Style::drawDialComplexControl;
-        break;
-    case CC_ScrollBar:
-        fcn = &Style::drawScrollBarComplexControl;
-        break;
-    case CC_TitleBar:
-        fcn = &Style::drawTitleBarComplexControl;
-        break;
-
-    // fallback
-    default:
-        break;
+    // nothing to do if outside of the area being repainted
+    if (isClippedOut(option, painter)) {
+        return;
     }
 
+    const WidgetExplorer::Timer<ComplexControl> timer(_widgetExplorer, element);
+    const Tracer::Event trace("draw", Tracer::name(element), widget, option ? option->rect.size() : QSize());
+    StyleComplexControl fcn(AdwaitaPrivate::dispatch(_complexControls, element));
+
     painter->save();
 
     // call function if implemented
@@ -1264,12 +2029,12 @@ bool Style::eventFilter(QObject *object, QEvent *event)
     }
 
     if (QEvent::PaletteChange == event->type()) {
-        configurationChanged();
+        updatePalette();
     }
 
     if ((!widget->parent() || !qobject_cast<QWidget *>(widget->parent()) || qobject_cast<QDialog *>(widget) || qobject_cast<QMainWindow *>(widget))
             && (event->type() == QEvent::Show || event->type() == QEvent::StyleChange)) {
-        configurationChanged();
+        updatePalette();
     }
 
     // fallback
@@ -1326,6 +2091,7 @@ bool Style::eventFilterScrollArea(QWidget *widget, QEvent *event)
         // render
         foreach (auto *child, children) {
             painter.drawRect(child->geometry());
+            _widgetExplorer->addPaintedRect(&painter, child->geometry());
         }
 
         break;
@@ -1573,8 +2339,39 @@ bool Style::eventFilterCommandLinkButton(QCommandLinkButton *button, QEvent *eve
 //_____________________________________________________________________
 void Style::configurationChanged(void)
 {
-    // reload configuration
-    loadConfiguration();
+    // settings are only reported when a value actually changed
+    loadConfiguration(SettingsPart);
+}
+
+//_____________________________________________________________________
+void Style::colorSchemeChanged(bool dark)
+{
+    // high contrast variants stay high contrast
+    switch (_variant) {
+    case Adwaita:
+    case AdwaitaDark:
+        setColorVariant(dark ? AdwaitaDark : Adwaita);
+        break;
+
+    case AdwaitaHighcontrast:
+    case AdwaitaHighcontrastInverse:
+        setColorVariant(dark ? AdwaitaHighcontrastInverse : AdwaitaHighcontrast);
+        break;
+
+    default:
+        break;
+    }
+}
+
+//_____________________________________________________________________
+void Style::updatePalette()
+{
+    // showing a window or changing a widget palette mostly leaves the application palette alone
+    if (!qApp || QGuiApplication::palette().cacheKey() == _paletteCacheKey) {
+        return;
+    }
+
+    loadConfiguration(PalettePart);
 }
 
 //____________________________________________________________________
@@ -1612,60 +2409,194 @@ QIcon Style::standardIconImplementation(StandardPixmap standardPixmap, const QSt
 }
 
 //_____________________________________________________________________
-void Style::loadConfiguration()
+void Style::loadConfiguration(int parts)
 {
-    // reinitialize engines
-    _animations->setupEngines();
-    _windowManager->initialize();
+    if (parts & SettingsPart) {
+        // reinitialize engines
+        _animations->setupEngines(*_runtimeConfig);
+        _windowManager->initialize();
 
-    // mnemonics
-    _mnemonics->setMode(Adwaita::Config::MnemonicsMode);
+        // mnemonics
+        _mnemonics->setMode(Adwaita::Config::MnemonicsMode);
 
-    // splitter proxy
-    _splitterFactory->setEnabled(Adwaita::Config::SplitterProxyEnabled);
+        // splitter proxy
+        _splitterFactory->setEnabled(_runtimeConfig->splitterProxyEnabled());
 
-    // clear icon cache
-    _iconCache.clear();
+        // clear sub control rects, since scrollbar buttons may change below
+        _subControlRectCache->clear();
 
-    // scrollbar buttons
-    switch (Adwaita::Config::ScrollBarAddLineButtons) {
-    case 0:
-        _addLineButtons = NoButton;
-        break;
-    case 1:
-        _addLineButtons = SingleButton;
-        break;
+        // scrollbar buttons
+        switch (Adwaita::Config::ScrollBarAddLineButtons) {
+        case 0:
+            _addLineButtons = NoButton;
+            break;
+        case 1:
+            _addLineButtons = SingleButton;
+            break;
 
-    default:
-    case 2:
-        _addLineButtons = DoubleButton;
-        break;
+        default:
+        case 2:
+            _addLineButtons = DoubleButton;
+            break;
+        }
+
+        switch (Adwaita::Config::ScrollBarSubLineButtons) {
+        case 0:
+            _subLineButtons = NoButton;
+            break;
+        case 1:
+            _subLineButtons = SingleButton;
+            break;
+
+        default:
+        case 2:
+            _subLineButtons = DoubleButton;
+            break;
+        }
+
+        // draw functions
+        loadDispatchTables();
+
+        // widget explorer
+        _widgetExplorer->setEnabled(Adwaita::Config::WidgetExplorerEnabled);
+        _widgetExplorer->setDrawWidgetRects(Adwaita::Config::DrawWidgetRects);
+        _widgetExplorer->setDrawOverdraw(Adwaita::Config::DrawOverdraw || (!qEnvironmentVariableIsEmpty("ADWAITA_OVERDRAW") && qEnvironmentVariable("ADWAITA_OVERDRAW") != QLatin1String("0")));
     }
 
-    switch (Adwaita::Config::ScrollBarSubLineButtons) {
-    case 0:
-        _subLineButtons = NoButton;
-        break;
-    case 1:
-        _subLineButtons = SingleButton;
-        break;
+    if ((parts & PalettePart) && qApp) {
+        _paletteCacheKey = QGuiApplication::palette().cacheKey();
 
-    default:
-    case 2:
-        _subLineButtons = DoubleButton;
-        break;
+        // clear icon cache
+        _iconCache.clear();
+
+        // tree branch indicators, tab shapes and slider ticks are keyed by color and need no clearing
+
+        // pre-render arrows and signs in the colors most widgets use
+        const QPalette palette(Colors::palette(_variant));
+        const QPalette::ColorRole roles[] = { QPalette::Text, QPalette::WindowText, QPalette::ButtonText };
+        for (QPalette::ColorRole role : roles) {
+            StyleOptions styleOptions(palette, _variant);
+            styleOptions.setColorRole(role);
+            Adwaita::Renderer::prewarmGlyphs(Colors::arrowOutlineColor(styleOptions), qApp->devicePixelRatio());
+        }
+    }
+}
+
+//_____________________________________________________________________
+void Style::loadDispatchTables()
+{
+    // the tables are written unchecked below, so every standard element, up to the last one of each enum, must fit
+    static_assert(PE_IndicatorTabTearRight < DispatchTableSize, "primitive out of the dispatch table range");
+    static_assert(CE_ShapedFrame < DispatchTableSize, "control out of the dispatch table range");
+    static_assert(CC_MdiControls < DispatchTableSize, "complex control out of the dispatch table range");
+
+    std::fill(_primitives, _primitives + DispatchTableSize, nullptr);
+    std::fill(_controls, _controls + DispatchTableSize, nullptr);
+    std::fill(_complexControls, _complexControls + DispatchTableSize, nullptr);
+
+    // primitives
+    _primitives[PE_PanelButtonCommand] = &Style::drawPanelButtonCommandPrimitive;
+    _primitives[PE_PanelButtonTool] = &Style::drawPanelButtonToolPrimitive;
+    _primitives[PE_PanelScrollAreaCorner] = &Style::drawPanelScrollAreaCornerPrimitive;
+    _primitives[PE_PanelMenu] = &Style::drawPanelMenuPrimitive;
+    _primitives[PE_PanelTipLabel] = &Style::drawPanelTipLabelPrimitive;
+    _primitives[PE_PanelItemViewRow] = &Style::drawPanelItemViewRowPrimitive;
+    _primitives[PE_PanelItemViewItem] = &Style::drawPanelItemViewItemPrimitive;
+    _primitives[PE_IndicatorCheckBox] = &Style::drawIndicatorCheckBoxPrimitive;
+    _primitives[PE_IndicatorRadioButton] = &Style::drawIndicatorRadioButtonPrimitive;
+    _primitives[PE_IndicatorButtonDropDown] = &Style::drawIndicatorButtonDropDownPrimitive;
+    _primitives[PE_IndicatorTabClose] = &Style::drawIndicatorTabClosePrimitive;
+    _primitives[PE_IndicatorTabTear] = &Style::drawIndicatorTabTearPrimitive;
+    _primitives[PE_IndicatorArrowUp] = &Style::drawIndicatorArrowUpPrimitive;
+    _primitives[PE_IndicatorArrowDown] = &Style::drawIndicatorArrowDownPrimitive;
+    _primitives[PE_IndicatorArrowLeft] = &Style::drawIndicatorArrowLeftPrimitive;
+    _primitives[PE_IndicatorArrowRight] = &Style::drawIndicatorArrowRightPrimitive;
+    _primitives[PE_IndicatorHeaderArrow] = &Style::drawIndicatorHeaderArrowPrimitive;
+    _primitives[PE_IndicatorToolBarSeparator] = &Style::drawIndicatorToolBarSeparatorPrimitive;
+    _primitives[PE_IndicatorBranch] = &Style::drawIndicatorBranchPrimitive;
+    _primitives[PE_FrameStatusBarItem] = &Style::emptyPrimitive;
+    _primitives[PE_Frame] = &Style::drawFramePrimitive;
+    _primitives[PE_FrameLineEdit] = &Style::drawFrameLineEditPrimitive;
+    _primitives[PE_FrameMenu] = &Style::drawFrameMenuPrimitive;
+    _primitives[PE_FrameGroupBox] = &Style::drawFrameGroupBoxPrimitive;
+    _primitives[PE_FrameTabWidget] = &Style::drawFrameTabWidgetPrimitive;
+    _primitives[PE_FrameTabBarBase] = &Style::drawFrameTabBarBasePrimitive;
+    _primitives[PE_FrameWindow] = &Style::drawFrameWindowPrimitive;
+
+    // toolbar handles
+    if (Adwaita::Config::ToolBarDrawItemSeparator) {
+        _primitives[PE_IndicatorToolBarHandle] = &Style::drawIndicatorToolBarHandlePrimitive;
+    } else {
+        _primitives[PE_IndicatorToolBarHandle] = &Style::emptyPrimitive;
     }
 
     // frame focus
     if (Adwaita::Config::ViewDrawFocusIndicator) {
-        _frameFocusPrimitive = &Style::drawFrameFocusRectPrimitive;
+        _primitives[PE_FrameFocusRect] = &Style::drawFrameFocusRectPrimitive;
     } else {
-        _frameFocusPrimitive = &Style::emptyPrimitive;
-    }
+        _primitives[PE_FrameFocusRect] = &Style::emptyPrimitive;
+    }
+
+    // controls
+    _controls[CE_PushButtonBevel] = &Style::drawPanelButtonCommandPrimitive;
+    _controls[CE_PushButtonLabel] = &Style::drawPushButtonLabelControl;
+    _controls[CE_CheckBoxLabel] = &Style::drawCheckBoxLabelControl;
+    _controls[CE_RadioButtonLabel] = &Style::drawCheckBoxLabelControl;
+    _controls[CE_ToolButtonLabel] = &Style::drawToolButtonLabelControl;
+    _controls[CE_ComboBoxLabel] = &Style::drawComboBoxLabelControl;
+    _controls[CE_MenuBarEmptyArea] = &Style::drawMenuBarEmptyArea;
+    _controls[CE_MenuBarItem] = &Style::drawMenuBarItemControl;
+    _controls[CE_MenuItem] = &Style::drawMenuItemControl;
+    _controls[CE_ToolBar] = &Style::emptyControl;
+    _controls[CE_ProgressBar] = &Style::drawProgressBarControl;
+    _controls[CE_ProgressBarContents] = &Style::drawProgressBarContentsControl;
+    _controls[CE_ProgressBarGroove] = &Style::drawProgressBarGrooveControl;
+    _controls[CE_ProgressBarLabel] = &Style::drawProgressBarLabelControl;
+    _controls[CE_ScrollBarSlider] = &Style::drawScrollBarSliderControl;
+    _controls[CE_ScrollBarAddLine] = &Style::drawScrollBarAddLineControl;
+    _controls[CE_ScrollBarSubLine] = &Style::drawScrollBarSubLineControl;
+    _controls[CE_ScrollBarAddPage] = &Style::emptyControl;
+    _controls[CE_ScrollBarSubPage] = &Style::emptyControl;
+    _controls[CE_ShapedFrame] = &Style::drawShapedFrameControl;
+    _controls[CE_RubberBand] = &Style::drawRubberBandControl;
+    _controls[CE_SizeGrip] = &Style::emptyControl;
+    _controls[CE_HeaderSection] = &Style::drawHeaderSectionControl;
+    _controls[CE_HeaderLabel] = &Style::drawHeaderLabelControl;
+    _controls[CE_HeaderEmptyArea] = &Style::drawHeaderEmptyAreaControl;
+    _controls[CE_TabBarTabLabel] = &Style::drawTabBarTabLabelControl;
+    _controls[CE_TabBarTabShape] = &Style::drawTabBarTabShapeControl;
+    _controls[CE_ToolBoxTabLabel] = &Style::drawToolBoxTabLabelControl;
+    _controls[CE_ToolBoxTabShape] = &Style::drawToolBoxTabShapeControl;
+    _controls[CE_DockWidgetTitle] = &Style::drawDockWidgetTitleControl;
+    _controls[CE_ItemViewItem] = &Style::drawItemViewItemControl;
+
+    // complex controls
+    _complexControls[CC_GroupBox] = &Style::drawGroupBoxComplexControl;
+    _complexControls[CC_ToolButton] = &Style::drawToolButtonComplexControl;
+    _complexControls[CC_ComboBox] = &Style::drawComboBoxComplexControl;
+    _complexControls[CC_SpinBox] = &Style::drawSpinBoxComplexControl;
+    _complexControls[CC_Slider] = &Style::drawSliderComplexControl;
+    _complexControls[CC_Dial] = &Style::drawDialComplexControl;
+    _complexControls[CC_ScrollBar] = &Style::drawScrollBarComplexControl;
+    _complexControls[CC_TitleBar] = &Style::drawTitleBarComplexControl;
+}
+
+//_____________________________________________________________________
+bool Style::isNativePrimitive(PrimitiveElement element) const
+{
+    return AdwaitaPrivate::dispatch(_primitives, element) != nullptr;
+}
+
+//_____________________________________________________________________
+bool Style::isNativeControl(ControlElement element) const
+{
+    return AdwaitaPrivate::dispatch(_controls, element) != nullptr;
+}
 
-    // widget explorer
-    _widgetExplorer->setEnabled(Adwaita::Config::WidgetExplorerEnabled);
-    _widgetExplorer->setDrawWidgetRects(Adwaita::Config::DrawWidgetRects);
+//_____________________________________________________________________
+bool Style::isNativeComplexControl(ComplexControl element) const
+{
+    return AdwaitaPrivate::dispatch(_complexControls, element) != nullptr;
 }
 
 //___________________________________________________________________________________________________________________
@@ -1859,6 +2790,97 @@ QRect Style::progressBarLabelRect(const QStyleOption *option, const QWidget *) c
     return rect;
 }
 
+//___________________________________________________________________________________________________________________
+QRect Style::progressBarDirtyRect(const QStyleOptionProgressBar *option, int previousProgress, const QWidget *widget) const
+{
+    // busy indicators move across the whole groove
+    bool busy(option->minimum == 0 && option->maximum == 0);
+    if (busy) {
+        return option->rect;
+    }
+
+    if (previousProgress == option->progress) {
+        return QRect();
+    }
+
+    // get orientation
+    const State &state(option->state);
+#if QT_VERSION >= 0x060000
+    bool horizontal(state & QStyle::State_Horizontal);
+#else
+    bool horizontal((state & QStyle::State_Horizontal) || (option->orientation == Qt::Horizontal));
+#endif
+
+    QStyleOptionProgressBar previousOption(*option);
+    previousOption.progress = previousProgress;
+
+    const QRect current(progressBarContentsRect(option, widget));
+    const QRect previous(progressBarContentsRect(&previousOption, widget));
+
+    QRect rect;
+    if (current != previous) {
+        // both rects grow from the same end of the groove, only the part covered by one of them changes
+        rect = current | previous;
+        const QRect common(current & previous);
+        if (common.isValid()) {
+            if (horizontal && common.left() == rect.left()) {
+                rect.setLeft(common.right() + 1);
+            } else if (horizontal) {
+                rect.setRight(common.left() - 1);
+            } else if (common.top() == rect.top()) {
+                rect.setTop(common.bottom() + 1);
+            } else {
+                rect.setBottom(common.top() - 1);
+            }
+        }
+
+        // short contents are padded to the bar thickness, and the outline reaches one pixel further
+        if (horizontal) {
+            rect.adjust(-Metrics::ProgressBar_Thickness, -1, Metrics::ProgressBar_Thickness, 1);
+        } else {
+            rect.adjust(-1, -Metrics::ProgressBar_Thickness, 1, Metrics::ProgressBar_Thickness);
+        }
+
+        rect &= option->rect;
+    }
+
+    // the label shows the value
+    if (option->textVisible) {
+        rect |= progressBarLabelRect(option, widget);
+    }
+
+    return rect;
+}
+
+//___________________________________________________________________________________________________________________
+QRect Style::progressBarUpdateRect(QWidget *widget, int previousValue) const
+{
+    const QProgressBar *progressBar(qobject_cast<const QProgressBar *>(widget));
+    if (!progressBar) {
+        return QRect();
+    }
+
+    // same option as the one QProgressBar paints with
+    QStyleOptionProgressBar option;
+    option.initFrom(progressBar);
+    option.minimum = progressBar->minimum();
+    option.maximum = progressBar->maximum();
+    option.progress = progressBar->value();
+    option.textAlignment = progressBar->alignment();
+    option.textVisible = progressBar->isTextVisible();
+    option.text = progressBar->text();
+    option.invertedAppearance = progressBar->invertedAppearance();
+    option.bottomToTop = progressBar->textDirection() == QProgressBar::BottomToTop;
+    if (progressBar->orientation() == Qt::Horizontal) {
+        option.state |= State_Horizontal;
+    }
+#if QT_VERSION < 0x060000
+    option.orientation = progressBar->orientation();
+#endif
+
+    return progressBarDirtyRect(&option, previousValue, widget);
+}
+
 //___________________________________________________________________________________________________________________
 QRect Style::headerArrowRect(const QStyleOption *option, const QWidget *) const
 {
@@ -4323,11 +5345,6 @@ bool Style::drawIndicatorTabTearPrimitive(const QStyleOption *option, QPainter *
 //___________________________________________________________________________________
 bool Style::drawIndicatorToolBarHandlePrimitive(const QStyleOption *option, QPainter *painter, const QWidget *) const
 {
-    // do nothing if disabled from options
-    if (!Adwaita::Config::ToolBarDrawItemSeparator) {
-        return true;
-    }
-
     // store rect and palette
     QRect rect(option->rect);
 
@@ -4407,6 +5424,63 @@ bool Style::drawIndicatorBranchPrimitive(const QStyleOption *option, QPainter *p
     const QRect &rect(option->rect);
     const QPalette &palette(option->palette);
 
+    // state
+    const State &state(option->state);
+    bool enabled(state & State_Enabled);
+    bool mouseOver((state & State_Active) && enabled && (state & State_MouseOver));
+
+    // expander color
+    QColor arrowColor;
+    if (state & State_Children) {
+        StyleOptions styleOptions(palette, _variant);
+        styleOptions.setColorRole(QPalette::Text);
+        arrowColor = mouseOver ? Colors::hoverColor(StyleOptions(palette, _variant)) : Colors::arrowOutlineColor(styleOptions);
+    }
+
+    // tree branches color
+    QColor lineColor;
+    if (Adwaita::Config::ViewDrawTreeBranchLines) {
+        lineColor = Colors::mix(palette.color(QPalette::Base), palette.color(QPalette::Text), 0.25);
+    }
+
+    const qreal devicePixelRatio(painter->device() ? painter->device()->devicePixelRatioF() : 1.0);
+
+    // paint directly when the painter is scaled or rotated, or when pixmaps cannot be used
+    if (rect.isEmpty() || rect.width() > 256 || rect.height() > 256 || !canUsePixmapCache(painter)) {
+        renderIndicatorBranch(option, painter, rect, arrowColor, lineColor, devicePixelRatio);
+        return true;
+    }
+
+    AdwaitaPrivate::BranchGlyphKey key;
+    key.size = rect.size();
+    key.state = state & (State_Item | State_Children | State_Sibling | State_Open);
+    key.direction = option->direction;
+    key.arrowColor = arrowColor.rgba();
+    key.lineColor = lineColor.rgba();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+    if (const QPixmap *pixmap = _branchGlyphCache->find(key)) {
+        painter->drawPixmap(rect.topLeft(), *pixmap);
+        return true;
+    }
+
+    QPixmap pixmap(qCeil(rect.width() * devicePixelRatio), qCeil(rect.height() * devicePixelRatio));
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    pixmap.fill(Qt::transparent);
+    {
+        QPainter pixmapPainter(&pixmap);
+        renderIndicatorBranch(option, &pixmapPainter, QRect(QPoint(0, 0), rect.size()), arrowColor, lineColor, devicePixelRatio);
+    }
+
+    _branchGlyphCache->insert(key, pixmap);
+    painter->drawPixmap(rect.topLeft(), pixmap);
+
+    return true;
+}
+
+//___________________________________________________________________________________
+void Style::renderIndicatorBranch(const QStyleOption *option, QPainter *painter, const QRect &rect, const QColor &arrowColor, const QColor &lineColor, qreal devicePixelRatio) const
+{
     // state
     const State &state(option->state);
     bool reverseLayout(option->direction == Qt::RightToLeft);
@@ -4416,8 +5490,6 @@ bool Style::drawIndicatorBranchPrimitive(const QStyleOption *option, QPainter *p
     if (state & State_Children) {
         // state
         bool expanderOpen(state & State_Open);
-        bool enabled(state & State_Enabled);
-        bool mouseOver((state & State_Active) && enabled && (state & State_MouseOver));
 
         // expander rect
         int expanderSize = qMin(rect.width(), rect.height());
@@ -4440,23 +5512,28 @@ bool Style::drawIndicatorBranchPrimitive(const QStyleOption *option, QPainter *p
         styleOptions.setColorRole(QPalette::Text);
         styleOptions.setPainter(painter);
         styleOptions.setRect(arrowRect);
-        styleOptions.setColor(mouseOver ? Colors::hoverColor(StyleOptions(palette, _variant)) : Colors::arrowOutlineColor(styleOptions));
+        styleOptions.setColor(arrowColor);
 
         // render
         Adwaita::Renderer::renderArrow(styleOptions, orientation);
     }
 
     // tree branches
-    if (!Adwaita::Config::ViewDrawTreeBranchLines) {
-        return true;
+    if (!lineColor.isValid()) {
+        return;
     }
 
+    /*
+     * at integer device pixel ratios the half pixel translation puts one pixel wide lines
+     * exactly on device pixels, so antialiasing would not change the result
+     */
+    bool snapToPixels(qFuzzyCompare(devicePixelRatio, qreal(qRound(devicePixelRatio))));
+
     QPoint center(rect.center());
-    QColor lineColor(Colors::mix(palette.color(QPalette::Base), palette.color(QPalette::Text), 0.25));
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, true);
-    painter->translate(0.5, 0.5);
-    painter->setPen(QPen(lineColor, 1));
+    PainterStateGuard guard(painter);
+    guard.setRenderHint(QPainter::Antialiasing, !snapToPixels);
+    guard.translate(0.5, 0.5);
+    guard.setPen(QPen(lineColor, 1));
     if (state & (State_Item | State_Children | State_Sibling)) {
         QLineF line(QPointF(center.x(), rect.top()), QPointF(center.x(), center.y() - expanderAdjust - 1));
         painter->drawLine(line);
@@ -4475,9 +5552,6 @@ bool Style::drawIndicatorBranchPrimitive(const QStyleOption *option, QPainter *p
         QLineF line(QPointF(center.x(), center.y() + expanderAdjust), QPointF(center.x(), rect.bottom()));
         painter->drawLine(line);
     }
-    painter->restore();
-
-    return true;
 }
 
 //___________________________________________________________________________________
@@ -4811,13 +5885,13 @@ bool Style::drawComboBoxLabelControl(const QStyleOption *option, QPainter *paint
     QPalette::ColorRole textRole = QPalette::ButtonText;
 
     // change pen color directly
-    painter->save();
-    painter->setPen(QPen(option->palette.color(textRole), 1));
+    PainterStateGuard guard(painter);
+    guard.setPen(QPen(option->palette.color(textRole), 1));
 
     if (const QStyleOptionComboBox *cb = qstyleoption_cast<const QStyleOptionComboBox *>(option)) {
         QRect editRect = proxy()->subControlRect(CC_ComboBox, cb, SC_ComboBoxEditField, widget);
-        painter->save();
-        painter->setClipRect(editRect);
+        PainterStateGuard clipGuard(painter);
+        clipGuard.setClipRect(editRect);
         if (!cb->currentIcon.isNull() && qobject_cast<const QComboBox *>(widget)) {
             QIcon::Mode mode;
 
@@ -4851,11 +5925,8 @@ bool Style::drawComboBoxLabelControl(const QStyleOption *option, QPainter *paint
                                   visualAlignment(cb->direction, Qt::AlignLeft | Qt::AlignVCenter),
                                   cb->palette, cb->state & State_Enabled, cb->currentText);
         }
-        painter->restore();
     }
 
-    painter->restore();
-
     return true;
 }
 
@@ -4889,13 +5960,12 @@ bool Style::drawMenuBarEmptyArea(const QStyleOption *option, QPainter *painter,
     const QRect &rect(option->rect);
     const QPalette &palette(option->palette);
 
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, false);
-    painter->setBrush(Qt::NoBrush);
-    painter->setPen(Colors::mix(palette.color(QPalette::Window), palette.color(QPalette::Shadow), 0.2));
+    PainterStateGuard guard(painter);
+    guard.setRenderHint(QPainter::Antialiasing, false);
+    guard.setBrush(Qt::NoBrush);
+    guard.setPen(Colors::mix(palette.color(QPalette::Window), palette.color(QPalette::Shadow), 0.2));
 
     painter->drawLine(rect.bottomLeft(), rect.bottomRight());
-    painter->restore();
 
     return true;
 }
@@ -4919,18 +5989,18 @@ bool Style::drawMenuBarItemControl(const QStyleOption *option, QPainter *painter
     bool sunken(enabled && (state & State_Sunken));
     bool useStrongFocus(Adwaita::Config::MenuItemDrawStrongFocus);
 
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, false);
+    PainterStateGuard guard(painter);
+    guard.setRenderHint(QPainter::Antialiasing, false);
 
-    painter->setBrush(palette.window().color());
-    painter->setPen(Qt::NoPen);
+    guard.setBrush(palette.window().color());
+    guard.setPen(Qt::NoPen);
     painter->drawRect(rect);
 
-    painter->setBrush(Qt::NoBrush);
-    painter->setPen(Colors::mix(palette.color(QPalette::Window), palette.color(QPalette::Shadow), 0.2));
+    guard.setBrush(Qt::NoBrush);
+    guard.setPen(Colors::mix(palette.color(QPalette::Window), palette.color(QPalette::Shadow), 0.2));
 
     painter->drawLine(rect.bottomLeft(), rect.bottomRight());
-    painter->restore();
+    guard.restore();
 
     // render hover and focus
     if (useStrongFocus && sunken) {
@@ -5838,8 +6908,8 @@ bool Style::drawTabBarTabLabelControl(const QStyleOption *option, QPainter *pain
         if (!proxy()->styleHint(SH_UnderlineShortcut, option, widget))
             alignment |= Qt::TextHideMnemonic;
 
+        PainterStateGuard guard(painter);
         if (verticalTabs) {
-            painter->save();
             int newX, newY, newRot;
             if (tab->shape == QTabBar::RoundedEast || tab->shape == QTabBar::TriangularEast) {
                 newX = tr.width() + tr.x();
@@ -5852,7 +6922,7 @@ bool Style::drawTabBarTabLabelControl(const QStyleOption *option, QPainter *pain
             }
             QTransform m = QTransform::fromTranslate(newX, newY);
             m.rotate(newRot);
-            painter->setTransform(m, true);
+            guard.setWorldTransform(m, true);
         }
         QRect iconRect;
         tabLayout(tab, widget, &tr, &iconRect, proxy());
@@ -5866,28 +6936,26 @@ bool Style::drawTabBarTabLabelControl(const QStyleOption *option, QPainter *pain
 
         QFont font = painter->font();
         font.setBold(true);
-        painter->setFont(font);
+        guard.setFont(font);
         if (!(tab->state & State_Enabled)) {
             if (tab->state & State_Selected) {
-                painter->setPen(Colors::mix(option->palette.brush(QPalette::Text).color(), option->palette.brush(QPalette::Window).color(), 0.3));
+                guard.setPen(Colors::mix(option->palette.brush(QPalette::Text).color(), option->palette.brush(QPalette::Window).color(), 0.3));
             } else {
-                painter->setPen(Colors::mix(option->palette.brush(QPalette::Text).color(), option->palette.brush(QPalette::Window).color(), 0.4));
+                guard.setPen(Colors::mix(option->palette.brush(QPalette::Text).color(), option->palette.brush(QPalette::Window).color(), 0.4));
             }
         } else {
             if (tab->state & State_Selected) {
-                painter->setPen(option->palette.brush(QPalette::WindowText).color());
+                guard.setPen(option->palette.brush(QPalette::WindowText).color());
             } else if (tab->state & State_Active && tab->state & State_MouseOver) {
-                painter->setPen(Colors::mix(option->palette.brush(QPalette::Dark).color(), option->palette.brush(QPalette::Text).color(), 0.7));
+                guard.setPen(Colors::mix(option->palette.brush(QPalette::Dark).color(), option->palette.brush(QPalette::Text).color(), 0.7));
             } else {
-                painter->setPen(Colors::mix(option->palette.brush(QPalette::Dark).color(), option->palette.brush(QPalette::Text).color(), 0.6));
+                guard.setPen(Colors::mix(option->palette.brush(QPalette::Dark).color(), option->palette.brush(QPalette::Text).color(), 0.6));
             }
         }
 
         proxy()->drawItemText(painter, tr, alignment, tab->palette, tab->state & State_Enabled, tab->text, QPalette::NoRole);
 
-        if (verticalTabs) {
-            painter->restore();
-        }
+        guard.restore();
 
         if (tab->state & State_HasFocus) {
             int OFFSET = 1 + pixelMetric(PM_DefaultFrameWidth);
@@ -5934,9 +7002,9 @@ bool Style::drawTabBarTabLabelControl(const QStyleOption *option, QPainter *pain
     // text rect
     QRect textRect(subElementRect(SE_TabBarTabText, option, widget));
 
+    PainterStateGuard guard(painter);
     if (verticalTabs) {
         // properly rotate painter
-        painter->save();
         int newX, newY, newRot;
         if (tabOption->shape == QTabBar::RoundedEast || tabOption->shape == QTabBar::TriangularEast) {
             newX = rect.width() + rect.x();
@@ -5951,16 +7019,12 @@ bool Style::drawTabBarTabLabelControl(const QStyleOption *option, QPainter *pain
         QTransform transform;
         transform.translate(newX, newY);
         transform.rotate(newRot);
-        painter->setTransform(transform, true);
+        guard.setWorldTransform(transform, true);
     }
 
     // adjust text rect based on font metrics
     textRect = option->fontMetrics.boundingRect(textRect, textFlags, tabOption->text);
 
-    if (verticalTabs) {
-        painter->restore();
-    }
-
     return true;
 }
 
@@ -6048,25 +7112,63 @@ bool Style::drawTabBarTabShapeControl(const QStyleOption *option, QPainter *pain
     QColor underline(enabled && selected ? Colors::focusColor(StyleOptions(palette, _variant)) : selected || mouseOver ? option->palette.color(QPalette::Window).darker() : Qt::transparent);
 
     // outline
+    const bool movable(widget && widget->property("movable").toBool());
     QColor outline = QColor();
-    if (selected && widget && widget->property("movable").toBool()) {
+    if (selected && movable) {
         outline = Colors::frameOutlineColor(StyleOptions(palette, _variant));
     }
 
     // background
     QColor background = Colors::tabBarColor(styleOptions);
 
-    // render
-    QRegion oldRegion(painter->clipRegion());
-    painter->setClipRect(option->rect, Qt::IntersectClip);
-
-    styleOptions.setPainter(painter);
-    styleOptions.setRect(rect);
     styleOptions.setColor(underline);
     styleOptions.setOutlineColor(outline);
 
-    Adwaita::Renderer::renderTabBarTab(styleOptions, background, corners, widget && widget->property("movable").toBool());
-    painter->setClipRegion(oldRegion);
+    const qreal devicePixelRatio(painter->device() ? painter->device()->devicePixelRatioF() : 1.0);
+
+    // paint directly when the painter is scaled or rotated, or when pixmaps cannot be used
+    if (rect.isEmpty() || rect.width() * rect.height() > AdwaitaPrivate::TabShapeCache::MaxCost / 16
+            || !canUsePixmapCache(painter)) {
+        QRegion oldRegion(painter->clipRegion());
+        painter->setClipRect(option->rect, Qt::IntersectClip);
+
+        styleOptions.setPainter(painter);
+        styleOptions.setRect(rect);
+
+        Adwaita::Renderer::renderTabBarTab(styleOptions, background, corners, movable);
+        painter->setClipRegion(oldRegion);
+
+        return true;
+    }
+
+    AdwaitaPrivate::TabShapeKey key;
+    key.size = rect.size();
+    key.corners = int(corners);
+    key.renderFrame = movable;
+    key.background = background.rgba();
+    key.underline = underline.rgba();
+    key.outline = outline.rgba();
+    key.outlineValid = outline.isValid();
+    key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+    if (const QPixmap *pixmap = _tabShapeCache->find(key)) {
+        painter->drawPixmap(rect.topLeft(), *pixmap);
+        return true;
+    }
+
+    // the pixmap bounds take care of clipping to the tab rect
+    QPixmap pixmap(qCeil(rect.width() * devicePixelRatio), qCeil(rect.height() * devicePixelRatio));
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    pixmap.fill(Qt::transparent);
+    {
+        QPainter pixmapPainter(&pixmap);
+        styleOptions.setPainter(&pixmapPainter);
+        styleOptions.setRect(QRect(QPoint(0, 0), rect.size()));
+        Adwaita::Renderer::renderTabBarTab(styleOptions, background, corners, movable);
+    }
+
+    _tabShapeCache->insert(key, pixmap);
+    painter->drawPixmap(rect.topLeft(), pixmap);
 
     return true;
 }
@@ -6256,12 +7358,11 @@ bool Style::drawDockWidgetTitleControl(const QStyleOption *option, QPainter *pai
         size.transpose();
         rect.setSize(size);
 
-        painter->save();
-        painter->translate(rect.left(), rect.top() + rect.width());
-        painter->rotate(-90);
-        painter->translate(-rect.left(), -rect.top());
+        PainterStateGuard guard(painter);
+        guard.translate(rect.left(), rect.top() + rect.width());
+        guard.rotate(-90);
+        guard.translate(-rect.left(), -rect.top());
         drawItemText(painter, rect, Qt::AlignLeft | Qt::AlignVCenter | _mnemonics->textFlags(), palette, enabled, title, QPalette::WindowText);
-        painter->restore();
     } else {
         drawItemText(painter, rect, Qt::AlignLeft | Qt::AlignVCenter | _mnemonics->textFlags(), palette, enabled, title, QPalette::WindowText);
     }
@@ -6273,7 +7374,7 @@ bool Style::drawDockWidgetTitleControl(const QStyleOption *option, QPainter *pai
 bool Style::drawGroupBoxComplexControl(const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget) const
 {
     if (const QStyleOptionGroupBox *groupBox = qstyleoption_cast<const QStyleOptionGroupBox *>(option)) {
-        painter->save();
+        PainterStateGuard guard(painter);
 
         QRect textRect = proxy()->subControlRect(CC_GroupBox, groupBox, SC_GroupBoxLabel, widget);
         QRect checkBoxRect = proxy()->subControlRect(CC_GroupBox, groupBox, SC_GroupBoxCheckBox, widget);
@@ -6282,7 +7383,7 @@ bool Style::drawGroupBoxComplexControl(const QStyleOptionComplex *option, QPaint
         if ((groupBox->subControls & QStyle::SC_GroupBoxLabel) && !groupBox->text.isEmpty()) {
             QColor textColor = groupBox->textColor;
             if (textColor.isValid()) {
-                painter->setPen(textColor);
+                guard.setPen(textColor);
             }
             int alignment = int(groupBox->textAlignment);
             if (!styleHint(QStyle::SH_UnderlineShortcut, option, widget)) {
@@ -6290,7 +7391,7 @@ bool Style::drawGroupBoxComplexControl(const QStyleOptionComplex *option, QPaint
             }
             QFont font = painter->font();
             font.setBold(true);
-            painter->setFont(font);
+            guard.setFont(font);
             painter->drawText(textRect, Qt::TextShowMnemonic | Qt::AlignLeft | Qt::AlignVCenter | alignment, groupBox->text);
         }
         if (groupBox->subControls & SC_GroupBoxCheckBox) {
@@ -6299,7 +7400,6 @@ bool Style::drawGroupBoxComplexControl(const QStyleOptionComplex *option, QPaint
             box.rect = checkBoxRect;
             proxy()->drawPrimitive(PE_IndicatorCheckBox, &box, painter, widget);
         }
-        painter->restore();
     }
 
     return true;
@@ -6718,50 +7818,71 @@ bool Style::drawSliderComplexControl(const QStyleOptionComplex *option, QPainter
         }
         if (interval >= 1) {
             int fudge(pixelMetric(PM_SliderLength, option, widget) / 2);
-            int current(sliderOption->minimum);
-
-            // store tick lines
             QRect grooveRect(subControlRect(CC_Slider, sliderOption, SC_SliderGroove, widget));
-            QList<QLine> tickLines;
-            if (horizontal) {
-                if (tickPosition & QSlider::TicksAbove) {
-                    tickLines.append(QLine(rect.left(), grooveRect.top() - Metrics::Slider_TickMarginWidth, rect.left(), grooveRect.top() - Metrics::Slider_TickMarginWidth - Metrics::Slider_TickLength));
-                }
-                if (tickPosition & QSlider::TicksBelow) {
-                    tickLines.append(QLine(rect.left(), grooveRect.bottom() + Metrics::Slider_TickMarginWidth, rect.left(), grooveRect.bottom() + Metrics::Slider_TickMarginWidth + Metrics::Slider_TickLength));
-                }
-            } else {
-                if (tickPosition & QSlider::TicksAbove) {
-                    tickLines.append(QLine(grooveRect.left() - Metrics::Slider_TickMarginWidth, rect.top(), grooveRect.left() - Metrics::Slider_TickMarginWidth - Metrics::Slider_TickLength, rect.top()));
-                }
-                if (tickPosition & QSlider::TicksBelow) {
-                    tickLines.append(QLine(grooveRect.right() + Metrics::Slider_TickMarginWidth, rect.top(), grooveRect.right() + Metrics::Slider_TickMarginWidth + Metrics::Slider_TickLength, rect.top()));
-                }
-            }
 
             // Style options
             StyleOptions styleOptions(palette, _variant);
 
             // colors
-            QColor base(Colors::separatorColor(styleOptions));
+            QColor color(Colors::separatorColor(styleOptions));
+
+            const qreal devicePixelRatio(painter->device() ? painter->device()->devicePixelRatioF() : 1.0);
 
-            while (current <= sliderOption->maximum) {
-                // adjust color
-                QColor color(base);
+            // paint directly when the painter is scaled or rotated, or when pixmaps cannot be used
+            if (!canUsePixmapCache(painter)) {
                 painter->setPen(color);
+                painter->drawLines(AdwaitaPrivate::sliderTickLines(sliderOption, grooveRect, interval, available, fudge));
+            } else {
+                AdwaitaPrivate::SliderTickKey key;
+                key.size = rect.size();
+                key.grooveRect = grooveRect.translated(-rect.topLeft());
+                key.tickPosition = tickPosition;
+                key.horizontal = horizontal;
+                key.upsideDown = upsideDown;
+                key.minimum = sliderOption->minimum;
+                key.maximum = sliderOption->maximum;
+                key.interval = interval;
+                key.available = available;
+                key.fudge = fudge;
+                key.color = color.rgba();
+                key.devicePixelRatio = qRound(devicePixelRatio * 100);
+
+                const AdwaitaPrivate::SliderTickCache::Layer *layer(_sliderTickCache->find(key));
+                if (!layer) {
+                    const QVector<QLine> lines(AdwaitaPrivate::sliderTickLines(sliderOption, grooveRect, interval, available, fudge));
+
+                    // lines are one pixel wide and drawn without antialiasing, their end points are enough to get the bounds.
+                    // Ticks above the groove run backwards, and normalized() would not keep both end points inside
+                    QRect bounds;
+                    for (const QLine &line : lines) {
+                        bounds |= QRect(QPoint(qMin(line.x1(), line.x2()), qMin(line.y1(), line.y2())),
+                                        QPoint(qMax(line.x1(), line.x2()), qMax(line.y1(), line.y2())));
+                    }
 
-                // calculate positions and draw lines
-                int position(sliderPositionFromValue(sliderOption->minimum, sliderOption->maximum, current, available) + fudge);
-                foreach (const QLine &tickLine, tickLines) {
-                    if (horizontal) {
-                        painter->drawLine(tickLine.translated(upsideDown ? (rect.width() - position) : position, 0));
+                    AdwaitaPrivate::SliderTickCache::Layer newLayer;
+                    newLayer.offset = bounds.topLeft() - rect.topLeft();
+                    if (!bounds.isEmpty()) {
+                        newLayer.pixmap = QPixmap(qCeil(bounds.width() * devicePixelRatio), qCeil(bounds.height() * devicePixelRatio));
+                        newLayer.pixmap.setDevicePixelRatio(devicePixelRatio);
+                        newLayer.pixmap.fill(Qt::transparent);
+
+                        QPainter pixmapPainter(&newLayer.pixmap);
+                        pixmapPainter.setPen(color);
+                        pixmapPainter.translate(-bounds.topLeft());
+                        pixmapPainter.drawLines(lines);
+                    }
+
+                    if (_sliderTickCache->insert(key, newLayer)) {
+                        layer = _sliderTickCache->find(key);
                     } else {
-                        painter->drawLine(tickLine.translated(0, upsideDown ? (rect.height() - position) : position));
+                        painter->setPen(color);
+                        painter->drawLines(lines);
                     }
                 }
 
-                // go to next position
-                current += interval;
+                if (layer && !layer->pixmap.isNull()) {
+                    painter->drawPixmap(rect.topLeft() + layer->offset, layer->pixmap);
+                }
             }
         }
     }
@@ -6929,6 +8050,9 @@ bool Style::drawDialComplexControl(const QStyleOptionComplex *option, QPainter *
     if (sliderOption->subControls & SC_DialTickmarks)
     {}
 
+    // value angle, shared by the highlight arc and the handle
+    const qreal valueAngle(dialAngle(sliderOption, sliderOption->sliderPosition));
+
     // groove
     if (sliderOption->subControls & SC_DialGroove) {
         // groove rect
@@ -6950,7 +8074,7 @@ bool Style::drawDialComplexControl(const QStyleOptionComplex *option, QPainter *
 
             // angles
             qreal first(dialAngle(sliderOption, sliderOption->minimum));
-            qreal second(dialAngle(sliderOption, sliderOption->sliderPosition));
+            qreal second(valueAngle);
 
             StyleOptions styleOptions(painter, grooveRect);
             styleOptions.setColor(highlight);
@@ -6991,7 +8115,7 @@ bool Style::drawDialComplexControl(const QStyleOptionComplex *option, QPainter *
         QColor shadow(Colors::shadowColor(styleOptions));
 
         // render
-        qreal angle = 270 - 180 * dialAngle(sliderOption, sliderOption->sliderPosition) / M_PI;
+        qreal angle = 270 - 180 * valueAngle / M_PI;
 
         styleOptions.setPainter(painter);
         styleOptions.setRect(handleRect);
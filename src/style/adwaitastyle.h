@@ -23,6 +23,7 @@
 #define ADWAITA_STYLE_H
 
 #include "adwaita.h"
+#include "adwaitarenderer.h"
 #include "config-adwaita.h"
 
 #include <QAbstractItemView>
@@ -32,6 +33,7 @@
 #include <QDockWidget>
 #include <QHash>
 #include <QIcon>
+#include <QMap>
 #include <QMdiSubWindow>
 #include <QStyleOption>
 #include <QWidget>
@@ -40,7 +42,11 @@
 
 namespace AdwaitaPrivate
 {
+class BranchGlyphCache;
+class SliderTickCache;
+class SubControlRectCache;
 class TabBarData;
+class TabShapeCache;
 }
 
 namespace Adwaita
@@ -48,6 +54,7 @@ namespace Adwaita
 class Animations;
 class Helper;
 class Mnemonics;
+class RuntimeConfig;
 class SplitterFactory;
 class WidgetExplorer;
 class WindowManager;
@@ -84,8 +91,42 @@ public:
     //* palette polishing
     virtual void polish(QPalette &palette);
 
+    //* application polishing. Follows the desktop color scheme when this is the application style
+    virtual void polish(QApplication *application);
+
+    //* application unpolishing
+    virtual void unpolish(QApplication *application);
+
     virtual QPalette standardPalette() const;
 
+    //*@name color variant
+    //@{
+
+    ColorVariant colorVariant(void) const
+    {
+        return _variant;
+    }
+
+    //* switch colors in place
+    /**
+     * widgets keep their polish, animation data and registrations. Only the palette dependent
+     * caches change and, when this is the application style, the application palette. Qt then
+     * coalesces the resulting repaints per window
+     */
+    void setColorVariant(ColorVariant variant);
+
+    //* true if this style is the application style, directly or behind proxy styles
+    bool isApplicationStyle(void) const;
+
+    //* switch colors in place, by style key such as "adwaita-dark". Returns false for unknown keys
+    /** invokable, so that applications can follow the desktop dark mode without linking to the style */
+    Q_INVOKABLE bool setColorVariant(const QString &key);
+
+    //* color variant for a style key, Unknown if it is not one of ours
+    static ColorVariant variantForKey(const QString &key);
+
+    //@}
+
     //* polish scrollarea
     void polishScrollArea(QAbstractScrollArea *scrollArea);
 
@@ -120,6 +161,65 @@ public:
     virtual void drawItemText(QPainter *painter, const QRect &rect, int alignment, const QPalette &palette, bool enabled,
                               const QString &text, QPalette::ColorRole textRole = QPalette::NoRole) const;
 
+    //*@name dispatch introspection, for profiling
+    //@{
+
+    //* true if primitive has a dedicated implementation, false if delegated to parent style
+    bool isNativePrimitive(PrimitiveElement element) const;
+
+    //* true if control has a dedicated implementation, false if delegated to parent style
+    bool isNativeControl(ControlElement element) const;
+
+    //* true if complex control has a dedicated implementation, false if delegated to parent style
+    bool isNativeComplexControl(ComplexControl element) const;
+
+    //* number of draw calls skipped because they fall outside of the painter clip region
+    quint64 rejectedDrawCalls(void) const
+    {
+        return _rejectedDrawCalls;
+    }
+
+    //* hit and size counters of the style and renderer caches, by cache name
+    QMap<QString, Renderer::CacheStatistics> cacheStatistics(void) const;
+
+    //* number of animation data objects, by engine name
+    QMap<QString, int> animationDataCounts(void) const;
+
+    //* widget explorer, which also times paint events and style calls
+    WidgetExplorer *widgetExplorer(void) const
+    {
+        return _widgetExplorer;
+    }
+
+    //* reset cache and rejected draw call counters, and the paint profile
+    void resetStatistics(void);
+
+    //* objects and memory held by one subsystem
+    struct MemoryUsage {
+        int objects = 0;
+        qint64 bytes = 0;
+    };
+
+    //* objects and memory held by the style, by subsystem. Bytes are estimates where Qt does not expose sizes
+    QMap<QString, MemoryUsage> memoryUsage(void) const;
+
+    //* print memory usage through the adwaita.style logging category
+    Q_INVOKABLE void dumpMemoryUsage(void) const;
+
+    //@}
+
+    //*@name partial updates
+    //@{
+
+    //* area of a progress bar that changes when its value moves from previousValue to the current one
+    /**
+     * progress bars updated at high frequency can repaint this rect rather than the whole widget.
+     * Invokable, so that applications can query it through QMetaObject without linking to the style
+     */
+    Q_INVOKABLE QRect progressBarUpdateRect(QWidget *widget, int previousValue) const;
+
+    //@}
+
     //*@name event filters
     //@{
 
@@ -145,6 +245,9 @@ protected Q_SLOTS:
     //* update configuration
     void configurationChanged(void);
 
+    //* follow the desktop dark mode toggle
+    void colorSchemeChanged(bool dark);
+
     //* standard icons
     virtual QIcon standardIconImplementation(StandardPixmap standardPixmap, const QStyleOption *option, const QWidget *widget) const;
 
@@ -156,8 +259,28 @@ protected:
         return standardIconImplementation(pixmap, option, widget);
     }
 
-    //* load configuration
-    void loadConfiguration();
+    //* configuration parts to reload
+    enum ConfigurationPart {
+        //* settings, which drive engines, window manager, mnemonics, splitters and dispatch tables
+        SettingsPart = 1 << 0,
+
+        //* application palette, which drives icons and pre-rendered glyphs
+        PalettePart = 1 << 1,
+
+        AllParts = SettingsPart | PalettePart
+    };
+
+    //* load the given configuration parts
+    void loadConfiguration(int parts = AllParts);
+
+    //* reload palette dependent parts, if the application palette changed since they were loaded
+    void updatePalette();
+
+    //* true if option rect lies outside of the painter clip and of the paint engine system clip, in which case nothing needs to be drawn
+    bool isClippedOut(const QStyleOption *option, const QPainter *painter) const;
+
+    //* fill dispatch tables, resolving configuration dependent implementations
+    void loadDispatchTables();
 
     //*@name subelementRect specialized functions
     //@{
@@ -177,6 +300,7 @@ protected:
     QRect progressBarGrooveRect(const QStyleOption *option, const QWidget *widget) const;
     QRect progressBarContentsRect(const QStyleOption *option, const QWidget *widget) const;
     QRect progressBarLabelRect(const QStyleOption *option, const QWidget *widget) const;
+    QRect progressBarDirtyRect(const QStyleOptionProgressBar *option, int previousProgress, const QWidget *widget) const;
     QRect headerArrowRect(const QStyleOption *option, const QWidget *widget) const;
     QRect headerLabelRect(const QStyleOption *option, const QWidget *widget) const;
     QRect sliderFocusRect(const QStyleOption *option, const QWidget *widget) const;
@@ -194,6 +318,9 @@ protected:
     //*@name subcontrol Rect specialized functions
     //@{
 
+    //* cached sub control rects for controls that are hit tested on mouse move
+    QRect cachedSubControlRect(ComplexControl element, const QStyleOptionComplex *option, SubControl subControl, const QWidget *widget) const;
+
     QRect groupBoxSubControlRect(const QStyleOptionComplex *option, SubControl subControl, const QWidget *widget) const;
     QRect toolButtonSubControlRect(const QStyleOptionComplex *option, SubControl subControl, const QWidget *widget) const;
     QRect comboBoxSubControlRect(const QStyleOptionComplex *option, SubControl subControl, const QWidget *widget) const;
@@ -285,6 +412,9 @@ protected:
     bool drawIndicatorToolBarSeparatorPrimitive(const QStyleOption *option, QPainter *painter, const QWidget *widget) const;
     bool drawIndicatorBranchPrimitive(const QStyleOption *option, QPainter *painter, const QWidget *widget) const;
 
+    //* paints tree branch expander and lines, either on screen or into the branch cache
+    void renderIndicatorBranch(const QStyleOption *option, QPainter *painter, const QRect &rect, const QColor &arrowColor, const QColor &lineColor, qreal devicePixelRatio) const;
+
     //@}
 
     //*@name controls specialized functions
@@ -509,6 +639,9 @@ private:
     //* helper
     Helper *_helper;
 
+    //* settings file overrides
+    RuntimeConfig *_runtimeConfig;
+
     //* animations
     Animations *_animations;
 
@@ -527,13 +660,27 @@ private:
     //* tabbar data
     AdwaitaPrivate::TabBarData *_tabBarData;
 
+    //* sub control rects, per control geometry
+    AdwaitaPrivate::SubControlRectCache *_subControlRectCache;
+
+    //* pre-rendered tree branch indicators
+    AdwaitaPrivate::BranchGlyphCache *_branchGlyphCache;
+
+    //* pre-rendered tab backgrounds
+    AdwaitaPrivate::TabShapeCache *_tabShapeCache;
+
+    //* pre-rendered slider tick marks
+    AdwaitaPrivate::SliderTickCache *_sliderTickCache;
+
     //* icon hash
     using IconCache = QHash<StandardPixmap, QIcon>;
     IconCache _iconCache;
 
+    //* cache key of the application palette the palette dependent parts were loaded with
+    qint64 _paletteCacheKey = 0;
+
     //* pointer to primitive specialized function
     using StylePrimitive = bool(Style::*)(const QStyleOption *option, QPainter *painter, const QWidget *widget) const;
-    StylePrimitive _frameFocusPrimitive = nullptr;
 
     //* pointer to control specialized function
     using StyleControl = bool (Style::*)(const QStyleOption *option, QPainter *painter, const QWidget *widget) const;
@@ -541,6 +688,21 @@ private:
     //* pointer to control specialized function
     using StyleComplexControl = bool (Style::*)(const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget) const;
 
+    //*@name dispatch tables, indexed by element, filled in loadConfiguration
+    //@{
+
+    //* elements above this size are delegated to parent style
+    enum { DispatchTableSize = 128 };
+
+    StylePrimitive _primitives[DispatchTableSize];
+    StyleControl _controls[DispatchTableSize];
+    StyleComplexControl _complexControls[DispatchTableSize];
+
+    //@}
+
+    //* number of draw calls rejected by isClippedOut
+    mutable quint64 _rejectedDrawCalls = 0;
+
     //*@name custom elements
     //@{
 
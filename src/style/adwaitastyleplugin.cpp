@@ -29,25 +29,12 @@ namespace Adwaita
 
 QStyle *StylePlugin::create(const QString &key)
 {
-    if (key.toLower() == QStringLiteral("adwaita")) {
-        return new Style(Adwaita::Adwaita);
+    const ColorVariant variant(Style::variantForKey(key));
+    if (variant == Adwaita::Unknown) {
+        return nullptr;
     }
 
-    if (key.toLower() == QStringLiteral("adwaita-dark")) {
-        return new Style(Adwaita::AdwaitaDark);
-    }
-
-    if (key.toLower() == QStringLiteral("adwaita-highcontrast") ||
-        key.toLower() == QStringLiteral("highcontrast")) {
-        return new Style(Adwaita::AdwaitaHighcontrast);
-    }
-
-    if (key.toLower() == QStringLiteral("adwaita-highcontrastinverse") ||
-        key.toLower() == QStringLiteral("highcontrastinverse")) {
-        return new Style(Adwaita::AdwaitaHighcontrastInverse);
-    }
-
-    return nullptr;
+    return new Style(variant);
 }
 
 StylePlugin::~StylePlugin()
@@ -0,0 +1,46 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#ifndef ADWAITA_TEST_UTILS_H
+#define ADWAITA_TEST_UTILS_H
+
+#include <QPluginLoader>
+#include <QStyle>
+#include <QStylePlugin>
+
+namespace Adwaita
+{
+
+//* style created by the plugin built along with the tests, nullptr if it cannot be loaded
+/**
+ * the plugin is a module, so tests only reach the style through QStyle
+ * virtuals, invokable methods and the session bus
+ */
+inline QStyle *createStyle(const QString &key = QStringLiteral("Adwaita"))
+{
+    QPluginLoader loader(QLatin1String(ADWAITA_STYLE_PLUGIN));
+    QStylePlugin *plugin(qobject_cast<QStylePlugin *>(loader.instance()));
+    return plugin ? plugin->create(key) : nullptr;
+}
+
+} // namespace Adwaita
+
+#endif // ADWAITA_TEST_UTILS_H
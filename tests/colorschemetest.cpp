@@ -0,0 +1,166 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitacolorscheme.h"
+
+#include <QDBusConnection>
+#include <QDBusVariant>
+#include <QSignalSpy>
+#include <QTest>
+
+//* settings portal stand in, registered on its own connection
+class MockPortal : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.portal.Settings")
+
+public:
+    //* constructor
+    explicit MockPortal(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+    //* color scheme returned by Read
+    uint _scheme = Adwaita::ColorScheme::PreferDark;
+
+public Q_SLOTS:
+    //* the portal wraps values in one more variant
+    QDBusVariant Read(const QString &, const QString &)
+    {
+        return QDBusVariant(QVariant::fromValue(QDBusVariant(_scheme)));
+    }
+
+Q_SIGNALS:
+    void SettingChanged(const QString &group, const QString &key, const QDBusVariant &value);
+};
+
+//* counts portal signals as seen from the session bus, to know when the color scheme has seen them too
+class SettingChangedCounter : public QObject
+{
+    Q_OBJECT
+
+public:
+    int _count = 0;
+
+public Q_SLOTS:
+    void settingChanged(const QString &, const QString &, const QDBusVariant &)
+    {
+        ++_count;
+    }
+};
+
+//* desktop color scheme, read from the mock portal
+class ColorSchemeTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void initialRead();
+    void settingChanged();
+
+private:
+    MockPortal *_portal = nullptr;
+};
+
+//____________________________________________________________________
+void ColorSchemeTest::initTestCase()
+{
+    QDBusConnection connection(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("mock")));
+    QVERIFY(connection.isConnected());
+
+    _portal = new MockPortal(this);
+    QVERIFY(connection.registerObject(QStringLiteral("/org/freedesktop/portal/desktop"), _portal, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals));
+    QVERIFY(connection.registerService(QStringLiteral("org.freedesktop.portal.Desktop")));
+}
+
+//____________________________________________________________________
+void ColorSchemeTest::initialRead()
+{
+    // the palette is light, the portal says dark: the first reply corrects the guess
+    Adwaita::ColorScheme *colorScheme(Adwaita::ColorScheme::instance());
+    QVERIFY(colorScheme);
+    QVERIFY(!colorScheme->dark());
+
+    QSignalSpy spy(colorScheme, &Adwaita::ColorScheme::darkChanged);
+    QSignalSpy toggledSpy(colorScheme, &Adwaita::ColorScheme::toggled);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toBool(), true);
+    QVERIFY(colorScheme->dark());
+
+    // the style keeps the variant it was started with, it only follows toggles
+    QCOMPARE(toggledSpy.count(), 0);
+}
+
+//____________________________________________________________________
+void ColorSchemeTest::settingChanged()
+{
+    Adwaita::ColorScheme *colorScheme(Adwaita::ColorScheme::instance());
+    QVERIFY(colorScheme->dark());
+
+    SettingChangedCounter counter;
+    QVERIFY(QDBusConnection::sessionBus().connect(QStringLiteral("org.freedesktop.portal.Desktop"), QStringLiteral("/org/freedesktop/portal/desktop"),
+                                                  QStringLiteral("org.freedesktop.portal.Settings"), QStringLiteral("SettingChanged"),
+                                                  &counter, SLOT(settingChanged(QString, QString, QDBusVariant))));
+
+    const QString appearance(QStringLiteral("org.freedesktop.appearance"));
+    const QString colorSchemeKey(QStringLiteral("color-scheme"));
+
+    struct Step {
+        QString group;
+        QString key;
+        uint scheme;
+        int emitted;
+        bool dark;
+    };
+
+    // no preference falls back to the light palette
+    const Step steps[] = {
+        { appearance, QStringLiteral("contrast"), Adwaita::ColorScheme::PreferLight, 0, true },
+        { QStringLiteral("org.gnome.desktop.interface"), colorSchemeKey, Adwaita::ColorScheme::PreferLight, 0, true },
+        { appearance, colorSchemeKey, Adwaita::ColorScheme::PreferDark, 0, true },
+        { appearance, colorSchemeKey, Adwaita::ColorScheme::PreferLight, 1, false },
+        { appearance, colorSchemeKey, Adwaita::ColorScheme::NoPreference, 0, false },
+        { appearance, colorSchemeKey, Adwaita::ColorScheme::PreferDark, 1, true },
+        { appearance, colorSchemeKey, Adwaita::ColorScheme::NoPreference, 1, false }
+    };
+
+    for (const Step &step : steps) {
+        QSignalSpy spy(colorScheme, &Adwaita::ColorScheme::darkChanged);
+        QSignalSpy toggledSpy(colorScheme, &Adwaita::ColorScheme::toggled);
+        const int count(counter._count);
+        Q_EMIT _portal->SettingChanged(step.group, step.key, QDBusVariant(step.scheme));
+        QTRY_COMPARE(counter._count, count + 1);
+        QCoreApplication::processEvents();
+
+        QCOMPARE(spy.count(), step.emitted);
+        QCOMPARE(toggledSpy.count(), step.emitted);
+        QCOMPARE(colorScheme->dark(), step.dark);
+        if (step.emitted) {
+            QCOMPARE(spy.first().first().toBool(), step.dark);
+        }
+    }
+}
+
+QTEST_MAIN(ColorSchemeTest)
+
+#include "colorschemetest.moc"
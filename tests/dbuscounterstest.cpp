@@ -0,0 +1,169 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatestutils.h"
+
+#include <QApplication>
+#include <QCheckBox>
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QImage>
+#include <QTest>
+
+//* style counters exported on the session bus
+class DBusCountersTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void registered();
+    void caches();
+    void profiling();
+    void memory();
+
+private:
+    //* calls method on the counters object, and returns the first argument of the reply
+    static QVariant call(const QString &method, const QVariantList &arguments = QVariantList());
+
+    //* paints a check box, which goes through the style caches
+    static void paintCheckBox();
+
+    //* sum of given field over all caches
+    static qulonglong cacheTotal(const QString &field);
+
+    //* service name
+    static QString service()
+    {
+        return QStringLiteral("org.fedoraproject.AdwaitaQt.pid%1").arg(QCoreApplication::applicationPid());
+    }
+};
+
+//____________________________________________________________________
+QVariant DBusCountersTest::call(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message(QDBusMessage::createMethodCall(service(), QStringLiteral("/Counters"), QStringLiteral("org.fedoraproject.AdwaitaQt.Counters"), method));
+    message.setArguments(arguments);
+
+    const QDBusMessage reply(QDBusConnection::sessionBus().call(message));
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) {
+        return QVariant();
+    }
+
+    return reply.arguments().first();
+}
+
+//____________________________________________________________________
+void DBusCountersTest::paintCheckBox()
+{
+    QCheckBox checkBox(QStringLiteral("Check box"));
+    checkBox.setChecked(true);
+    checkBox.resize(checkBox.sizeHint());
+
+    QImage image(checkBox.size(), QImage::Format_ARGB32_Premultiplied);
+    checkBox.render(&image);
+}
+
+//____________________________________________________________________
+qulonglong DBusCountersTest::cacheTotal(const QString &field)
+{
+    qulonglong total(0);
+    const QVariantMap caches(qdbus_cast<QVariantMap>(call(QStringLiteral("caches"))));
+    for (const QVariant &cache : caches) {
+        total += qdbus_cast<QVariantMap>(cache).value(field).toULongLong();
+    }
+
+    return total;
+}
+
+//____________________________________________________________________
+void DBusCountersTest::initTestCase()
+{
+    QVERIFY(QDBusConnection::sessionBus().isConnected());
+
+    // the counters are only created on request
+    qputenv("ADWAITA_DBUS_COUNTERS", "1");
+    QStyle *style(Adwaita::createStyle());
+    QVERIFY(style);
+    QApplication::setStyle(style);
+}
+
+//____________________________________________________________________
+void DBusCountersTest::registered()
+{
+    QVERIFY(QDBusConnection::sessionBus().interface()->isServiceRegistered(service()));
+}
+
+//____________________________________________________________________
+void DBusCountersTest::caches()
+{
+    const QVariantMap caches(qdbus_cast<QVariantMap>(call(QStringLiteral("caches"))));
+    QVERIFY(caches.contains(QStringLiteral("glyphs")));
+    QVERIFY(caches.contains(QStringLiteral("indicatorSprites")));
+    QVERIFY(caches.contains(QStringLiteral("subControlRects")));
+
+    // painting goes through the caches, and reset clears the counts
+    paintCheckBox();
+    paintCheckBox();
+    QVERIFY(cacheTotal(QStringLiteral("hits")) + cacheTotal(QStringLiteral("misses")) > 0);
+
+    call(QStringLiteral("reset"));
+    QCOMPARE(cacheTotal(QStringLiteral("hits")), qulonglong(0));
+    QCOMPARE(cacheTotal(QStringLiteral("misses")), qulonglong(0));
+    QCOMPARE(call(QStringLiteral("rejectedDrawCalls")).toULongLong(), qulonglong(0));
+}
+
+//____________________________________________________________________
+void DBusCountersTest::profiling()
+{
+    QCOMPARE(call(QStringLiteral("profiling")).toBool(), false);
+
+    // draw calls are only counted while profiling
+    call(QStringLiteral("setProfiling"), QVariantList() << true);
+    QCOMPARE(call(QStringLiteral("profiling")).toBool(), true);
+
+    paintCheckBox();
+    QVERIFY(!qdbus_cast<QVariantMap>(call(QStringLiteral("drawCalls"))).isEmpty());
+
+    call(QStringLiteral("setProfiling"), QVariantList() << false);
+    call(QStringLiteral("reset"));
+    QVERIFY(qdbus_cast<QVariantMap>(call(QStringLiteral("drawCalls"))).isEmpty());
+}
+
+//____________________________________________________________________
+void DBusCountersTest::memory()
+{
+    const QVariantMap memory(qdbus_cast<QVariantMap>(call(QStringLiteral("memory"))));
+    QVERIFY(!memory.isEmpty());
+
+    qlonglong bytes(0);
+    for (const QVariant &subsystem : memory) {
+        bytes += qdbus_cast<QVariantMap>(subsystem).value(QStringLiteral("bytes")).toLongLong();
+    }
+
+    QVERIFY(bytes >= call(QStringLiteral("pixmapBytes")).toLongLong());
+}
+
+QTEST_MAIN(DBusCountersTest)
+
+#include "dbuscounterstest.moc"
@@ -0,0 +1,117 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatestutils.h"
+
+#include <QApplication>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTest>
+
+//* option independent pixel metrics and style hints, and the layouts that query them
+class MetricsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void staticMetrics();
+    void pixelMetric();
+    void formLayout_data();
+    void formLayout();
+};
+
+//____________________________________________________________________
+void MetricsBenchmark::initTestCase()
+{
+    QStyle *style(Adwaita::createStyle());
+    QVERIFY(style);
+    QApplication::setStyle(style);
+}
+
+//____________________________________________________________________
+void MetricsBenchmark::staticMetrics()
+{
+    // values served by the metric tables
+    const QStyle *style(QApplication::style());
+    QCOMPARE(style->pixelMetric(QStyle::PM_ButtonShiftHorizontal), 0);
+    QCOMPARE(style->pixelMetric(QStyle::PM_MenuVMargin), 2);
+    QCOMPARE(style->styleHint(QStyle::SH_FormLayoutFieldGrowthPolicy), int(QFormLayout::ExpandingFieldsGrow));
+    QCOMPARE(style->styleHint(QStyle::SH_FormLayoutWrapPolicy), int(QFormLayout::DontWrapRows));
+    QCOMPARE(style->styleHint(QStyle::SH_ToolTipLabel_Opacity), 204);
+
+    // both spacings come from the same table entry
+    QCOMPARE(style->pixelMetric(QStyle::PM_LayoutHorizontalSpacing), style->pixelMetric(QStyle::PM_LayoutVerticalSpacing));
+}
+
+//____________________________________________________________________
+void MetricsBenchmark::pixelMetric()
+{
+    const QStyle *style(QApplication::style());
+    const QStyle::PixelMetric metrics[] = {
+        QStyle::PM_LayoutHorizontalSpacing, QStyle::PM_LayoutVerticalSpacing,
+        QStyle::PM_LayoutLeftMargin, QStyle::PM_LayoutTopMargin,
+        QStyle::PM_DefaultFrameWidth, QStyle::PM_ScrollBarExtent,
+        QStyle::PM_IndicatorWidth, QStyle::PM_SmallIconSize
+    };
+
+    int sum(0);
+    QBENCHMARK {
+        for (QStyle::PixelMetric metric : metrics) {
+            sum += style->pixelMetric(metric);
+        }
+    }
+
+    QVERIFY(sum > 0);
+}
+
+//____________________________________________________________________
+void MetricsBenchmark::formLayout_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::newRow("10 rows") << 10;
+    QTest::newRow("100 rows") << 100;
+}
+
+//____________________________________________________________________
+void MetricsBenchmark::formLayout()
+{
+    QFETCH(int, rows);
+
+    QWidget widget;
+    QFormLayout *layout(new QFormLayout(&widget));
+    for (int row = 0; row < rows; ++row) {
+        layout->addRow(new QLabel(QStringLiteral("Label %1").arg(row)), new QLineEdit());
+    }
+
+    // every activation asks the style for spacings, margins and form layout hints
+    QBENCHMARK {
+        layout->invalidate();
+        layout->activate();
+    }
+
+    QVERIFY(widget.minimumSizeHint().height() > 0);
+}
+
+QTEST_MAIN(MetricsBenchmark)
+
+#include "metricsbenchmark.moc"
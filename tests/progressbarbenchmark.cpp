@@ -0,0 +1,123 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatestutils.h"
+
+#include <QApplication>
+#include <QImage>
+#include <QProgressBar>
+#include <QTest>
+
+//* area repainted when a progress bar value changes
+class ProgressBarBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void updateRect();
+    void repaint_data();
+    void repaint();
+
+private:
+    //* calls the style invokable
+    static QRect queryUpdateRect(QWidget *, int previousValue);
+};
+
+//____________________________________________________________________
+QRect ProgressBarBenchmark::queryUpdateRect(QWidget *widget, int previousValue)
+{
+    QRect rect;
+    QMetaObject::invokeMethod(QApplication::style(), "progressBarUpdateRect", Qt::DirectConnection, Q_RETURN_ARG(QRect, rect),
+                              Q_ARG(QWidget *, widget), Q_ARG(int, previousValue));
+    return rect;
+}
+
+//____________________________________________________________________
+void ProgressBarBenchmark::initTestCase()
+{
+    QStyle *style(Adwaita::createStyle());
+    QVERIFY(style);
+    QApplication::setStyle(style);
+}
+
+//____________________________________________________________________
+void ProgressBarBenchmark::updateRect()
+{
+    QProgressBar progressBar;
+    progressBar.setRange(0, 1000);
+    progressBar.setTextVisible(false);
+    progressBar.resize(300, 30);
+    progressBar.setValue(500);
+
+    // one step only touches a narrow band around the end of the contents
+    const QRect rect(queryUpdateRect(&progressBar, 499));
+    QVERIFY(rect.isValid());
+    QVERIFY(rect.width() < progressBar.width() / 4);
+    QVERIFY(progressBar.rect().contains(rect));
+
+    // nothing changes
+    QVERIFY(queryUpdateRect(&progressBar, 500).isEmpty());
+
+    // the label shows the value
+    progressBar.setTextVisible(true);
+    QVERIFY(queryUpdateRect(&progressBar, 500).isValid());
+
+    // busy indicators move across the whole bar
+    progressBar.setRange(0, 0);
+    QCOMPARE(queryUpdateRect(&progressBar, 0), progressBar.rect());
+
+    // not a progress bar
+    QWidget widget;
+    QVERIFY(queryUpdateRect(&widget, 0).isNull());
+}
+
+//____________________________________________________________________
+void ProgressBarBenchmark::repaint_data()
+{
+    QTest::addColumn<bool>("partial");
+    QTest::newRow("whole widget") << false;
+    QTest::newRow("update rect") << true;
+}
+
+//____________________________________________________________________
+void ProgressBarBenchmark::repaint()
+{
+    QFETCH(bool, partial);
+
+    QProgressBar progressBar;
+    progressBar.setRange(0, 1000);
+    progressBar.setTextVisible(false);
+    progressBar.resize(600, 30);
+    progressBar.setValue(500);
+
+    const QRegion region(partial ? QRegion(queryUpdateRect(&progressBar, 499)) : QRegion(progressBar.rect()));
+    QVERIFY(!region.isEmpty());
+
+    QImage image(progressBar.size(), QImage::Format_ARGB32_Premultiplied);
+    QBENCHMARK {
+        progressBar.render(&image, QPoint(), region);
+    }
+}
+
+QTEST_MAIN(ProgressBarBenchmark)
+
+#include "progressbarbenchmark.moc"
@@ -0,0 +1,124 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatestutils.h"
+
+#include <QApplication>
+#include <QImage>
+#include <QListWidget>
+#include <QPainter>
+#include <QStyleOptionViewItem>
+#include <QTest>
+
+//* item view selections, painted as plain fills when pixel aligned
+class SelectionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void selectionFill_data();
+    void selectionFill();
+    void listView_data();
+    void listView();
+};
+
+//____________________________________________________________________
+void SelectionBenchmark::initTestCase()
+{
+    QStyle *style(Adwaita::createStyle());
+    QVERIFY(style);
+    QApplication::setStyle(style);
+}
+
+//____________________________________________________________________
+void SelectionBenchmark::selectionFill_data()
+{
+    QTest::addColumn<bool>("antialiasing");
+    QTest::addColumn<QPoint>("offset");
+    QTest::newRow("aliased") << false << QPoint(0, 0);
+    QTest::newRow("antialiased") << true << QPoint(0, 0);
+    QTest::newRow("translated") << true << QPoint(3, 5);
+}
+
+//____________________________________________________________________
+void SelectionBenchmark::selectionFill()
+{
+    QFETCH(bool, antialiasing);
+    QFETCH(QPoint, offset);
+
+    QStyleOptionViewItem option;
+    option.rect = QRect(10, 10, 50, 20);
+    option.state = QStyle::State_Enabled | QStyle::State_Active | QStyle::State_Selected;
+    option.palette.setColor(QPalette::Active, QPalette::Highlight, Qt::blue);
+
+    QImage image(80, 50, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        painter.translate(offset);
+        QApplication::style()->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, &painter);
+    }
+
+    // the selection covers its rect exactly, with no blended edges
+    const QRect rect(option.rect.translated(offset));
+    QCOMPARE(image.pixelColor(rect.topLeft()), QColor(Qt::blue));
+    QCOMPARE(image.pixelColor(rect.bottomRight()), QColor(Qt::blue));
+    QCOMPARE(image.pixel(rect.topLeft() - QPoint(1, 1)), qRgba(0, 0, 0, 0));
+    QCOMPARE(image.pixel(rect.bottomRight() + QPoint(1, 1)), qRgba(0, 0, 0, 0));
+}
+
+//____________________________________________________________________
+void SelectionBenchmark::listView_data()
+{
+    QTest::addColumn<bool>("selected");
+    QTest::newRow("no selection") << false;
+    QTest::newRow("all selected") << true;
+}
+
+//____________________________________________________________________
+void SelectionBenchmark::listView()
+{
+    QFETCH(bool, selected);
+
+    QListWidget view;
+    view.setSelectionMode(QAbstractItemView::ExtendedSelection);
+    for (int row = 0; row < 100; ++row) {
+        view.addItem(QStringLiteral("Item %1").arg(row));
+    }
+
+    if (selected) {
+        view.selectAll();
+    }
+
+    view.resize(400, 600);
+    view.doItemsLayout();
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QBENCHMARK {
+        view.viewport()->render(&image);
+    }
+}
+
+QTEST_MAIN(SelectionBenchmark)
+
+#include "selectionbenchmark.moc"
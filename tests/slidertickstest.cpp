@@ -0,0 +1,148 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "adwaitatestutils.h"
+
+#include <QApplication>
+#include <QImage>
+#include <QPainter>
+#include <QSlider>
+#include <QStyleOptionSlider>
+#include <QTest>
+#include <QThread>
+
+//* paints slider tick marks outside of the gui thread, where the style cannot use its pixmap caches
+class DirectPaintThread : public QThread
+{
+public:
+    //* constructor
+    explicit DirectPaintThread(const QStyleOptionSlider &option)
+        : _option(option)
+    {
+    }
+
+    //* option
+    QStyleOptionSlider _option;
+
+    //* painted image
+    QImage _image;
+
+protected:
+    void run();
+};
+
+//* cached slider tick marks against the ones painted directly
+class SliderTicksTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void ticks_data();
+    void ticks();
+
+public:
+    //* tick marks for option
+    static QImage paintTicks(const QStyleOptionSlider &option);
+};
+
+//____________________________________________________________________
+void DirectPaintThread::run()
+{
+    _image = SliderTicksTest::paintTicks(_option);
+}
+
+//____________________________________________________________________
+QImage SliderTicksTest::paintTicks(const QStyleOptionSlider &option)
+{
+    QImage image(option.rect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    QApplication::style()->drawComplexControl(QStyle::CC_Slider, &option, &painter);
+    return image;
+}
+
+//____________________________________________________________________
+void SliderTicksTest::initTestCase()
+{
+    QStyle *style(Adwaita::createStyle());
+    QVERIFY(style);
+    QApplication::setStyle(style);
+}
+
+//____________________________________________________________________
+void SliderTicksTest::ticks_data()
+{
+    QTest::addColumn<int>("orientation");
+    QTest::addColumn<int>("tickPosition");
+    QTest::addColumn<bool>("upsideDown");
+
+    QTest::newRow("above") << int(Qt::Horizontal) << int(QSlider::TicksAbove) << false;
+    QTest::newRow("below") << int(Qt::Horizontal) << int(QSlider::TicksBelow) << false;
+    QTest::newRow("both sides") << int(Qt::Horizontal) << int(QSlider::TicksBothSides) << false;
+    QTest::newRow("above, upside down") << int(Qt::Horizontal) << int(QSlider::TicksAbove) << true;
+    QTest::newRow("left") << int(Qt::Vertical) << int(QSlider::TicksLeft) << false;
+    QTest::newRow("right") << int(Qt::Vertical) << int(QSlider::TicksRight) << false;
+    QTest::newRow("vertical, both sides") << int(Qt::Vertical) << int(QSlider::TicksBothSides) << true;
+}
+
+//____________________________________________________________________
+void SliderTicksTest::ticks()
+{
+    QFETCH(int, orientation);
+    QFETCH(int, tickPosition);
+    QFETCH(bool, upsideDown);
+
+    QStyleOptionSlider option;
+    option.orientation = Qt::Orientation(orientation);
+    option.rect = orientation == Qt::Horizontal ? QRect(0, 0, 200, 40) : QRect(0, 0, 40, 200);
+    option.state = QStyle::State_Enabled;
+    if (orientation == Qt::Horizontal) {
+        option.state |= QStyle::State_Horizontal;
+    }
+
+    option.minimum = 0;
+    option.maximum = 100;
+    option.tickInterval = 10;
+    option.pageStep = 10;
+    option.tickPosition = QSlider::TickPosition(tickPosition);
+    option.upsideDown = upsideDown;
+    option.subControls = QStyle::SC_SliderTickmarks;
+
+    DirectPaintThread thread(option);
+    thread.start();
+    QVERIFY(thread.wait());
+
+    const QImage direct(thread._image);
+    QVERIFY(!direct.isNull());
+    QImage empty(direct.size(), direct.format());
+    empty.fill(Qt::transparent);
+    QVERIFY(direct != empty);
+
+    // the first call renders the cached layer, the second one only blits it
+    QCOMPARE(paintTicks(option), direct);
+    QCOMPARE(paintTicks(option), direct);
+}
+
+QTEST_MAIN(SliderTicksTest)
+
+#include "slidertickstest.moc"
@@ -0,0 +1,208 @@
+/*************************************************************************
+ * Copyright (C) 2014 by Hugo Pereira Da Costa <hugo.pereira@free.fr>    *
+ * Copyright (C) 2014-2018 Martin Bříza <m@rtinbriza.cz>                 *
+ * Copyright (C) 2019-2021 Jan Grulich <jgrulich@redhat.com>             *
+ *                                                                       *
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "animations/adwaitatabbardata.h"
+
+#include <QApplication>
+#include <QTabBar>
+#include <QTest>
+
+//* exposes the tab hit test of the animation data
+class TestTabBarData : public Adwaita::TabBarData
+{
+public:
+    //* constructor
+    explicit TestTabBarData(QTabBar *target)
+        : TabBarData(target, target, 0)
+    {
+    }
+
+    using TabBarData::tabAt;
+};
+
+//* tab hit tests against the cached tab rects
+class TabBarDataTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void tabAt_data();
+    void tabAt();
+    void tabsChanged();
+    void benchmark_data();
+    void benchmark();
+
+private:
+    //* tab bar with count tabs, laid out in full
+    static void setupTabBar(QTabBar &, int count);
+
+    //* points along the tab bar, one every step pixels, and a few outside of it
+    static QVector<QPoint> probes(const QTabBar &, int step);
+};
+
+//____________________________________________________________________
+void TabBarDataTest::setupTabBar(QTabBar &tabBar, int count)
+{
+    for (int index = 0; index < count; ++index) {
+        tabBar.addTab(QStringLiteral("Tab %1").arg(index));
+    }
+
+    tabBar.resize(tabBar.sizeHint());
+}
+
+//____________________________________________________________________
+QVector<QPoint> TabBarDataTest::probes(const QTabBar &tabBar, int step)
+{
+    const QRect rect(tabBar.rect());
+    const bool vertical(rect.height() > rect.width());
+
+    QVector<QPoint> out;
+    if (vertical) {
+        for (int y = -step; y < rect.height() + step; y += step) {
+            out.append(QPoint(rect.center().x(), y));
+        }
+    } else {
+        for (int x = -step; x < rect.width() + step; x += step) {
+            out.append(QPoint(x, rect.center().y()));
+        }
+    }
+
+    out.append(QPoint(-1, -1));
+    out.append(rect.bottomRight() + QPoint(1, 1));
+    return out;
+}
+
+//____________________________________________________________________
+void TabBarDataTest::tabAt_data()
+{
+    QTest::addColumn<int>("shape");
+    QTest::addColumn<int>("direction");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("hidden");
+
+    QTest::newRow("single tab") << int(QTabBar::RoundedNorth) << int(Qt::LeftToRight) << 1 << -1;
+    QTest::newRow("north") << int(QTabBar::RoundedNorth) << int(Qt::LeftToRight) << 20 << -1;
+    QTest::newRow("north, right to left") << int(QTabBar::RoundedNorth) << int(Qt::RightToLeft) << 20 << -1;
+    QTest::newRow("west") << int(QTabBar::RoundedWest) << int(Qt::LeftToRight) << 20 << -1;
+    QTest::newRow("east") << int(QTabBar::TriangularEast) << int(Qt::LeftToRight) << 20 << -1;
+    QTest::newRow("hidden tab") << int(QTabBar::RoundedNorth) << int(Qt::LeftToRight) << 20 << 5;
+}
+
+//____________________________________________________________________
+void TabBarDataTest::tabAt()
+{
+    QFETCH(int, shape);
+    QFETCH(int, direction);
+    QFETCH(int, count);
+    QFETCH(int, hidden);
+
+    QTabBar tabBar;
+    tabBar.setShape(QTabBar::Shape(shape));
+    tabBar.setLayoutDirection(Qt::LayoutDirection(direction));
+    setupTabBar(tabBar, count);
+    if (hidden >= 0) {
+        tabBar.setTabVisible(hidden, false);
+    }
+
+    tabBar.setCurrentIndex(count / 2);
+
+    const TestTabBarData data(&tabBar);
+    const QVector<QPoint> points(probes(tabBar, 3));
+    for (const QPoint &point : points) {
+        QCOMPARE(data.tabAt(&tabBar, point), tabBar.tabAt(point));
+    }
+}
+
+//____________________________________________________________________
+void TabBarDataTest::tabsChanged()
+{
+    QTabBar tabBar;
+    setupTabBar(tabBar, 10);
+
+    const TestTabBarData data(&tabBar);
+    const QPoint center(tabBar.tabRect(4).center());
+    QCOMPARE(data.tabAt(&tabBar, center), 4);
+
+    // inserting a tab shifts the others, removing one shrinks the bar
+    tabBar.insertTab(0, QStringLiteral("First"));
+    tabBar.resize(tabBar.sizeHint());
+    QCOMPARE(data.tabAt(&tabBar, center), tabBar.tabAt(center));
+
+    tabBar.removeTab(0);
+    tabBar.removeTab(0);
+    tabBar.resize(tabBar.sizeHint());
+    const QVector<QPoint> points(probes(tabBar, 5));
+    for (const QPoint &point : points) {
+        QCOMPARE(data.tabAt(&tabBar, point), tabBar.tabAt(point));
+    }
+
+    // renaming a tab in the middle resizes it and moves the tabs after it
+    tabBar.setTabText(4, QStringLiteral("A much longer title than before"));
+    for (const QPoint &point : points) {
+        QCOMPARE(data.tabAt(&tabBar, point), tabBar.tabAt(point));
+    }
+}
+
+//____________________________________________________________________
+void TabBarDataTest::benchmark_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cached");
+
+    const int counts[] = {10, 100, 1000};
+    for (int count : counts) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 tabs, QTabBar").arg(count))) << count << false;
+        QTest::newRow(qPrintable(QStringLiteral("%1 tabs, cached").arg(count))) << count << true;
+    }
+}
+
+//____________________________________________________________________
+void TabBarDataTest::benchmark()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cached);
+
+    QTabBar tabBar;
+    setupTabBar(tabBar, count);
+
+    const TestTabBarData data(&tabBar);
+    const QVector<QPoint> points(probes(tabBar, qMax(1, tabBar.width() / 100)));
+    int found(0);
+    if (cached) {
+        QBENCHMARK {
+            for (const QPoint &point : points) {
+                found += data.tabAt(&tabBar, point) >= 0;
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const QPoint &point : points) {
+                found += tabBar.tabAt(point) >= 0;
+            }
+        }
+    }
+
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(TabBarDataTest)
+
+#include "tabbardatatest.moc"